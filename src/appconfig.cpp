@@ -36,6 +36,7 @@
  * THE SOFTWARE.
  */
 #include "appconfig.h"
+#include "batchreader.h"
 
 namespace depgraphV
 {
@@ -46,7 +47,10 @@ namespace depgraphV
 		  _language( "en" ),
 		  _showDonateOnExit( true ),
 		  _warnOnGraphRemoval( true ),
-		  _warnOnGraphClearing( true )
+		  _warnOnGraphClearing( true ),
+		  _hashFileContents( false ),
+		  _ioUringReads( false ),
+		  _ioUringQueueDepth( BatchReader::defaultQueueDepth() )
 	{
 		registerSerializable( this );
 		_availableTranslations.insert( "en", "" );
@@ -149,6 +153,9 @@ namespace depgraphV
 				 << "warnOnGraphClearing"
 				 << "redrawGraphOnFileSystemChanges"
 				 << "autoApplySettingChanges"
+				 << "hashFileContents"
+				 << "ioUringReads"
+				 << "ioUringQueueDepth"
 				 << "lastImgFormat"
 				 << "lastImgSavePath"
 				 << "lastDotSavePath";
@@ -65,6 +65,9 @@ namespace depgraphV
 		Q_PROPERTY( bool warnOnGraphClearing READ warnOnGraphClearing WRITE setWarnOnGraphClearing )
 		Q_PROPERTY( bool redrawGraphOnFileSystemChanges READ redrawGraphOnFileSystemChanges WRITE setRedrawGraphOnFileSystemChanges )
 		Q_PROPERTY( bool autoApplySettingChanges READ autoApplySettingChanges WRITE setAutoApplySettingChanges )
+		Q_PROPERTY( bool hashFileContents READ hashFileContents WRITE setHashFileContents )
+		Q_PROPERTY( bool ioUringReads READ ioUringReads WRITE setIoUringReads )
+		Q_PROPERTY( int ioUringQueueDepth READ ioUringQueueDepth WRITE setIoUringQueueDepth )
 		Q_PROPERTY( QString lastImgFormat READ lastImgFormat WRITE setLastImgFormat )
 		Q_PROPERTY( QString lastImgSavePath READ lastImgSavePath WRITE setLastImgSavePath )
 		Q_PROPERTY( QString lastDotSavePath READ lastDotSavePath WRITE setLastDotSavePath )
@@ -142,6 +145,20 @@ namespace depgraphV
 
 		bool autoApplySettingChanges() const { return _autoApplySettingChanges; }
 
+		/**
+		 * @return True if parsed files are hashed, so that a file whose
+		 * timestamp changed but whose content did not is not parsed again.
+		 */
+		bool hashFileContents() const { return _hashFileContents; }
+
+		/**
+		 * @return True if scanned folders are read through io_uring (Linux
+		 * only), keeping ioUringQueueDepth() files in flight per parser.
+		 */
+		bool ioUringReads() const { return _ioUringReads; }
+
+		int ioUringQueueDepth() const { return _ioUringQueueDepth; }
+
 		const QString& lastImgFormat() const { return _lastImgFormat; }
 
 		const QString& lastImgSavePath() const { return _lastImgSavePath; }
@@ -167,6 +184,12 @@ namespace depgraphV
 
 		void setAutoApplySettingChanges( bool value ) { _autoApplySettingChanges = value; }
 
+		void setHashFileContents( bool value ) { _hashFileContents = value; }
+
+		void setIoUringReads( bool value ) { _ioUringReads = value; }
+
+		void setIoUringQueueDepth( int value ) { _ioUringQueueDepth = value; }
+
 		void setLastImgFormat( const QString& value ) { _lastImgFormat = value; }
 
 		void setLastImgSavePath( const QString& value ) { _lastImgSavePath = value; }
@@ -212,6 +235,9 @@ namespace depgraphV
 		bool _warnOnGraphClearing;
 		bool _redrawGraphOnFileSystemChanges;
 		bool _autoApplySettingChanges;
+		bool _hashFileContents;
+		bool _ioUringReads;
+		int _ioUringQueueDepth;
 		QString _lastImgFormat;
 		QString _lastImgSavePath;
 		QString _lastDotSavePath;
@@ -0,0 +1,590 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * batchreader.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "batchreader.h"
+#include "filereader.h"
+
+#ifdef DEPGRAPHV_HAVE_IO_URING
+#	include <linux/io_uring.h>
+#	include <sys/mman.h>
+
+//Opening, reading and stat'ing through the ring came with Linux 5.6 headers
+#	if defined( __NR_io_uring_setup ) && defined( STATX_INO ) && \
+	   defined( IORING_FEAT_CUR_PERSONALITY )
+#		define DEPGRAPHV_USE_IO_URING
+#	endif
+#endif
+
+namespace depgraphV
+{
+#ifdef DEPGRAPHV_USE_IO_URING
+	/**
+	 * @brief The BatchReaderRing class owns an io_uring instance: its file
+	 * descriptor and the submission and completion rings shared with the
+	 * kernel.
+	 */
+	class BatchReaderRing
+	{
+	public:
+		/**
+		 * @brief Return a ring of at least \a entries entries, or null if
+		 * io_uring (or one of the needed operations) is not available.
+		 */
+		static BatchReaderRing* create( unsigned int entries );
+		~BatchReaderRing();
+
+		/**
+		 * @brief Return a zeroed submission queue entry, to be filled and
+		 * submitted by the next call to submit().
+		 */
+		io_uring_sqe* nextSqe( __u64 userData );
+
+		/**
+		 * @brief Submit the pending entries and wait for at least
+		 * \a minComplete completions.
+		 */
+		bool submit( unsigned int minComplete );
+
+		/**
+		 * @brief Wait for a completion without submitting anything.
+		 */
+		bool wait();
+
+		/**
+		 * @brief Return the number of entries not yet taken by the kernel.
+		 */
+		unsigned int unsubmitted() const { return _toSubmit; }
+
+		/**
+		 * @brief Pop the oldest completion, if any, into \a cqe.
+		 */
+		bool nextCqe( io_uring_cqe* cqe );
+
+	private:
+		BatchReaderRing();
+
+		int _fd;
+		void* _sqRing;
+		size_t _sqRingSize;
+		void* _cqRing;
+		size_t _cqRingSize;
+		io_uring_sqe* _sqes;
+		size_t _sqesSize;
+
+		unsigned* _sqHead;
+		unsigned* _sqTail;
+		unsigned* _sqMask;
+		unsigned* _sqArray;
+		unsigned _sqEntries;
+		unsigned* _cqHead;
+		unsigned* _cqTail;
+		unsigned* _cqMask;
+		io_uring_cqe* _cqes;
+		unsigned _toSubmit;
+
+		Q_DISABLE_COPY( BatchReaderRing )
+	};
+	//-------------------------------------------------------------------------
+	BatchReaderRing::BatchReaderRing()
+		: _fd( -1 ),
+		  _sqRing( MAP_FAILED ),
+		  _sqRingSize( 0 ),
+		  _cqRing( MAP_FAILED ),
+		  _cqRingSize( 0 ),
+		  _sqes( static_cast<io_uring_sqe*>( MAP_FAILED ) ),
+		  _sqesSize( 0 ),
+		  _toSubmit( 0 )
+	{
+	}
+	//-------------------------------------------------------------------------
+	BatchReaderRing* BatchReaderRing::create( unsigned int entries )
+	{
+		QScopedPointer<BatchReaderRing> ring( new BatchReaderRing );
+		io_uring_params params;
+		memset( &params, 0, sizeof( params ) );
+		ring->_fd = static_cast<int>( syscall( __NR_io_uring_setup, entries, &params ) );
+		if( ring->_fd < 0 )
+			return 0;
+
+		//Every operation the reader submits must be supported
+		const int maxOps = 256;
+		QByteArray probeBuffer( sizeof( io_uring_probe ) + maxOps * sizeof( io_uring_probe_op ), 0 );
+		io_uring_probe* probe = reinterpret_cast<io_uring_probe*>( probeBuffer.data() );
+		if( syscall( __NR_io_uring_register, ring->_fd, IORING_REGISTER_PROBE, probe, maxOps ) < 0 )
+			return 0;
+
+		const int ops[] = { IORING_OP_STATX, IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE };
+		for( unsigned int i = 0; i < sizeof( ops ) / sizeof( ops[ 0 ] ); ++i )
+		{
+			if( ops[ i ] > probe->last_op || !( probe->ops[ ops[ i ] ].flags & IO_URING_OP_SUPPORTED ) )
+				return 0;
+		}
+
+		ring->_sqRingSize = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+		ring->_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+		bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+		if( singleMap )
+		{
+			ring->_sqRingSize = qMax( ring->_sqRingSize, ring->_cqRingSize );
+			ring->_cqRingSize = ring->_sqRingSize;
+		}
+
+		ring->_sqRing = mmap( 0, ring->_sqRingSize, PROT_READ | PROT_WRITE,
+							  MAP_SHARED | MAP_POPULATE, ring->_fd, IORING_OFF_SQ_RING
+		);
+		if( ring->_sqRing == MAP_FAILED )
+			return 0;
+
+		if( singleMap )
+			ring->_cqRing = ring->_sqRing;
+		else
+		{
+			ring->_cqRing = mmap( 0, ring->_cqRingSize, PROT_READ | PROT_WRITE,
+								  MAP_SHARED | MAP_POPULATE, ring->_fd, IORING_OFF_CQ_RING
+			);
+			if( ring->_cqRing == MAP_FAILED )
+				return 0;
+		}
+
+		ring->_sqesSize = params.sq_entries * sizeof( io_uring_sqe );
+		ring->_sqes = static_cast<io_uring_sqe*>(
+						  mmap( 0, ring->_sqesSize, PROT_READ | PROT_WRITE,
+								MAP_SHARED | MAP_POPULATE, ring->_fd, IORING_OFF_SQES )
+		);
+		if( ring->_sqes == MAP_FAILED )
+			return 0;
+
+		char* sq = static_cast<char*>( ring->_sqRing );
+		ring->_sqHead = reinterpret_cast<unsigned*>( sq + params.sq_off.head );
+		ring->_sqTail = reinterpret_cast<unsigned*>( sq + params.sq_off.tail );
+		ring->_sqMask = reinterpret_cast<unsigned*>( sq + params.sq_off.ring_mask );
+		ring->_sqArray = reinterpret_cast<unsigned*>( sq + params.sq_off.array );
+		ring->_sqEntries = params.sq_entries;
+
+		char* cq = static_cast<char*>( ring->_cqRing );
+		ring->_cqHead = reinterpret_cast<unsigned*>( cq + params.cq_off.head );
+		ring->_cqTail = reinterpret_cast<unsigned*>( cq + params.cq_off.tail );
+		ring->_cqMask = reinterpret_cast<unsigned*>( cq + params.cq_off.ring_mask );
+		ring->_cqes = reinterpret_cast<io_uring_cqe*>( cq + params.cq_off.cqes );
+
+		return ring.take();
+	}
+	//-------------------------------------------------------------------------
+	BatchReaderRing::~BatchReaderRing()
+	{
+		if( _sqes != MAP_FAILED )
+			munmap( _sqes, _sqesSize );
+
+		if( _cqRing != MAP_FAILED && _cqRing != _sqRing )
+			munmap( _cqRing, _cqRingSize );
+
+		if( _sqRing != MAP_FAILED )
+			munmap( _sqRing, _sqRingSize );
+
+		if( _fd >= 0 )
+			::close( _fd );
+	}
+	//-------------------------------------------------------------------------
+	io_uring_sqe* BatchReaderRing::nextSqe( __u64 userData )
+	{
+		//Only this thread moves the tail, the kernel moves the head
+		unsigned tail = *_sqTail;
+		if( tail - __atomic_load_n( _sqHead, __ATOMIC_ACQUIRE ) >= _sqEntries )
+			return 0;
+
+		unsigned index = tail & *_sqMask;
+		io_uring_sqe* sqe = &_sqes[ index ];
+		memset( sqe, 0, sizeof( io_uring_sqe ) );
+		sqe->user_data = userData;
+		_sqArray[ index ] = index;
+		__atomic_store_n( _sqTail, tail + 1, __ATOMIC_RELEASE );
+		_toSubmit++;
+		return sqe;
+	}
+	//-------------------------------------------------------------------------
+	bool BatchReaderRing::submit( unsigned int minComplete )
+	{
+		for( ;; )
+		{
+			long submitted = syscall( __NR_io_uring_enter, _fd, _toSubmit, minComplete,
+									  minComplete ? IORING_ENTER_GETEVENTS : 0, 0, 0
+			);
+			if( submitted >= 0 )
+			{
+				_toSubmit -= static_cast<unsigned>( submitted );
+				return true;
+			}
+
+			//The kernel is short of resources; reaping completions helps
+			if( errno == EAGAIN || errno == EBUSY )
+				return true;
+
+			if( errno != EINTR )
+				return false;
+		}
+	}
+	//-------------------------------------------------------------------------
+	bool BatchReaderRing::wait()
+	{
+		for( ;; )
+		{
+			if( syscall( __NR_io_uring_enter, _fd, 0, 1, IORING_ENTER_GETEVENTS, 0, 0 ) >= 0 )
+				return true;
+
+			if( errno != EINTR )
+				return false;
+		}
+	}
+	//-------------------------------------------------------------------------
+	bool BatchReaderRing::nextCqe( io_uring_cqe* cqe )
+	{
+		//Only this thread moves the head, the kernel moves the tail
+		unsigned head = *_cqHead;
+		if( head == __atomic_load_n( _cqTail, __ATOMIC_ACQUIRE ) )
+			return false;
+
+		*cqe = _cqes[ head & *_cqMask ];
+		__atomic_store_n( _cqHead, head + 1, __ATOMIC_RELEASE );
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	/**
+	 * @brief A file in flight: each one goes through statx, openat, one or
+	 * more reads and close, with a single operation queued at a time.
+	 */
+	struct BatchReaderSlot
+	{
+		enum Stage
+		{
+			Free,
+			Stat,
+			Open,
+			Read,
+			Close
+		};
+
+		Stage stage;
+		QString path;
+		QByteArray nativePath;
+		struct statx stx;
+		ParseCache::FileStamp stamp;
+		int fd;
+		qint64 done;
+		QByteArray buffer;
+	};
+	//-------------------------------------------------------------------------
+	/**
+	 * @brief Read the file at \a path the usual way, when the ring cannot
+	 * be used anymore; \a stamp is null if the stamp sink did not see it yet.
+	 */
+	static void readWithoutRing( const QString& path, const ParseCache::FileStamp* stamp,
+								 const BatchReader::StampSink& stampSink,
+								 const BatchReader::ContentSink& contentSink )
+	{
+		ParseCache::FileStamp fileStamp = { 0, 0, 0 };
+		if( stamp )
+			fileStamp = *stamp;
+		else
+		{
+			if( !ParseCache::FileStamp::read( path, &fileStamp ) )
+			{
+				contentSink( path, fileStamp, 0, -1 );
+				return;
+			}
+
+			if( !stampSink( path, fileStamp ) )
+				return;
+		}
+
+		FileReader reader;
+		if( reader.open( path ) )
+			contentSink( path, fileStamp, reader.data(), reader.size() );
+		else
+			contentSink( path, fileStamp, 0, -1 );
+	}
+#else
+	class BatchReaderRing
+	{
+	};
+#endif // DEPGRAPHV_USE_IO_URING
+	//-------------------------------------------------------------------------
+	BatchReader::BatchReader( int queueDepth )
+		: _ring( 0 ),
+		  _queueDepth( qBound( 1, queueDepth, maxQueueDepth() ) )
+	{
+#ifdef DEPGRAPHV_USE_IO_URING
+		_ring = BatchReaderRing::create( _queueDepth );
+#endif
+	}
+	//-------------------------------------------------------------------------
+	BatchReader::~BatchReader()
+	{
+		delete _ring;
+	}
+	//-------------------------------------------------------------------------
+	bool BatchReader::isSupported()
+	{
+		static const bool supported = BatchReader( 2 ).isValid();
+		return supported;
+	}
+	//-------------------------------------------------------------------------
+	bool BatchReader::read( const PathSource& source, const StampSink& stampSink,
+							const ContentSink& contentSink,
+							const CancellationToken* cancellation )
+	{
+		Q_ASSERT( isValid() );
+#ifdef DEPGRAPHV_USE_IO_URING
+		typedef BatchReaderSlot Slot;
+		QVector<Slot> slots( _queueDepth );
+		QVector<int> freeSlots;
+		for( int i = _queueDepth - 1; i >= 0; --i )
+		{
+			slots[ i ].stage = Slot::Free;
+			freeSlots << i;
+		}
+
+		const ParseCache::FileStamp noStamp = { 0, 0, 0 };
+		const unsigned int maxReadSize = 1 << 30;
+		int inFlight = 0;
+		bool exhausted = false;
+		bool cancelled = false;
+
+		for( ;; )
+		{
+			cancelled = cancelled || CancellationToken::isCancelled( cancellation );
+
+			//Keep the ring full; block for more paths only when it is empty
+			while( !exhausted && !cancelled && !freeSlots.isEmpty() )
+			{
+				int index = freeSlots.last();
+				Slot& slot = slots[ index ];
+				if( !source( &slot.path, inFlight == 0 ) )
+				{
+					exhausted = inFlight == 0;
+					break;
+				}
+
+				freeSlots.pop_back();
+				inFlight++;
+				slot.stage = Slot::Stat;
+				slot.fd = -1;
+				slot.nativePath = QFile::encodeName( slot.path );
+				io_uring_sqe* sqe = _ring->nextSqe( index );
+				sqe->opcode = IORING_OP_STATX;
+				sqe->fd = AT_FDCWD;
+				sqe->addr = reinterpret_cast<__u64>( slot.nativePath.constData() );
+				sqe->len = STATX_SIZE | STATX_MTIME | STATX_INO;
+				sqe->off = reinterpret_cast<__u64>( &slot.stx );
+			}
+
+			if( inFlight == 0 )
+			{
+				if( exhausted || cancelled )
+					break;
+
+				continue;
+			}
+
+			if( !_ring->submit( 1 ) )
+			{
+				qWarning() << "io_uring_enter failed:" << strerror( errno );
+
+				//The kernel still writes into the slots of the entries it
+				//took: wait for every one of them before leaving
+				unsigned int submitted = inFlight - _ring->unsubmitted();
+				while( submitted > 0 )
+				{
+					io_uring_cqe cqe;
+					if( !_ring->nextCqe( &cqe ) )
+					{
+						//Completions are posted anyway, poll for them
+						if( !_ring->wait() )
+							usleep( 1000 );
+
+						continue;
+					}
+
+					submitted--;
+					Slot& slot = slots[ static_cast<int>( cqe.user_data ) ];
+					if( slot.stage == Slot::Open && cqe.res >= 0 )
+						slot.fd = cqe.res;
+					else if( slot.stage == Slot::Close )
+						slot.stage = Slot::Free;
+				}
+
+				//Files not delivered yet are read again without the ring
+				cancelled = cancelled || CancellationToken::isCancelled( cancellation );
+				for( int i = 0; i < slots.count(); ++i )
+				{
+					Slot& slot = slots[ i ];
+					if( slot.stage == Slot::Free )
+						continue;
+
+					if( slot.fd >= 0 )
+						::close( slot.fd );
+
+					if( slot.stage != Slot::Close && !cancelled )
+					{
+						readWithoutRing( slot.path, slot.stage == Slot::Stat ? 0 : &slot.stamp,
+										 stampSink, contentSink
+						);
+					}
+				}
+
+				delete _ring;
+				_ring = 0;
+				return false;
+			}
+
+			io_uring_cqe cqe;
+			while( _ring->nextCqe( &cqe ) )
+			{
+				int index = static_cast<int>( cqe.user_data );
+				Slot& slot = slots[ index ];
+				Slot::Stage next = Slot::Free;
+
+				switch( slot.stage )
+				{
+				case Slot::Stat:
+					if( cqe.res < 0 )
+					{
+						if( !cancelled )
+							contentSink( slot.path, noStamp, 0, -1 );
+						break;
+					}
+
+					slot.stamp.size = slot.stx.stx_size;
+					slot.stamp.mtime = qint64( slot.stx.stx_mtime.tv_sec ) * 1000000000 +
+									   slot.stx.stx_mtime.tv_nsec;
+					slot.stamp.inode = slot.stx.stx_ino;
+					if( !cancelled && stampSink( slot.path, slot.stamp ) )
+						next = Slot::Open;
+
+					break;
+
+				case Slot::Open:
+					if( cqe.res < 0 )
+					{
+						if( !cancelled )
+							contentSink( slot.path, slot.stamp, 0, -1 );
+						break;
+					}
+
+					slot.fd = cqe.res;
+					slot.done = 0;
+					if( slot.buffer.size() < slot.stamp.size )
+						slot.buffer.resize( slot.stamp.size );
+
+					next = slot.stamp.size > 0 && !cancelled ? Slot::Read : Slot::Close;
+					if( next == Slot::Close && !cancelled )
+						contentSink( slot.path, slot.stamp, slot.buffer.constData(), 0 );
+
+					break;
+
+				case Slot::Read:
+					if( cqe.res > 0 )
+						slot.done += cqe.res;
+
+					//Files may shrink meanwhile; a short read is not an error
+					if( cqe.res > 0 && slot.done < slot.stamp.size && !cancelled )
+					{
+						next = Slot::Read;
+						break;
+					}
+
+					if( !cancelled )
+					{
+						if( cqe.res < 0 )
+							contentSink( slot.path, slot.stamp, 0, -1 );
+						else
+							contentSink( slot.path, slot.stamp, slot.buffer.constData(), slot.done );
+					}
+
+					next = Slot::Close;
+					break;
+
+				case Slot::Close:
+				case Slot::Free:
+					break;
+				}
+
+				slot.stage = next;
+				if( next == Slot::Free )
+				{
+					freeSlots << index;
+					inFlight--;
+					continue;
+				}
+
+				//Each slot has a single operation queued, so there is always
+				//room in the ring
+				io_uring_sqe* sqe = _ring->nextSqe( index );
+				Q_ASSERT( sqe );
+				switch( next )
+				{
+				case Slot::Open:
+					sqe->opcode = IORING_OP_OPENAT;
+					sqe->fd = AT_FDCWD;
+					sqe->addr = reinterpret_cast<__u64>( slot.nativePath.constData() );
+					sqe->open_flags = O_RDONLY | O_CLOEXEC;
+					break;
+
+				case Slot::Read:
+					sqe->opcode = IORING_OP_READ;
+					sqe->fd = slot.fd;
+					sqe->addr = reinterpret_cast<__u64>( slot.buffer.data() + slot.done );
+					sqe->len = static_cast<unsigned int>(
+								   qMin<qint64>( slot.stamp.size - slot.done, maxReadSize ) );
+					sqe->off = slot.done;
+					break;
+
+				default:
+					sqe->opcode = IORING_OP_CLOSE;
+					sqe->fd = slot.fd;
+					break;
+				}
+			}
+		}
+#else
+		Q_UNUSED( source );
+		Q_UNUSED( stampSink );
+		Q_UNUSED( contentSink );
+		Q_UNUSED( cancellation );
+#endif
+		return true;
+	}
+} // end of depgraphV namespace
@@ -0,0 +1,135 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * batchreader.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef BATCHREADER_H
+#define BATCHREADER_H
+
+#ifndef PARSECACHE_H
+#	include "parsecache.h"
+#endif
+
+#ifndef CANCELLATIONTOKEN_H
+#	include "cancellationtoken.h"
+#endif
+
+namespace depgraphV
+{
+	class BatchReaderRing;
+
+	/**
+	 * @brief The BatchReader class reads many files at once through a Linux
+	 * io_uring, so that the latency of each stat, open, read and close call
+	 * overlaps with the others instead of adding up.
+	 *
+	 * Up to queueDepth() files are in flight at any time; each of them is
+	 * stat'ed first, and only read if the stamp sink asks for its content
+	 * (on a parse cache miss, for instance). Sinks run on the thread which
+	 * called read(), one file at a time.
+	 *
+	 * io_uring is not available everywhere (older kernels, other platforms,
+	 * sandboxes which forbid it): check isValid() and fall back to the usual
+	 * per-file reads otherwise.
+	 */
+	class BatchReader
+	{
+	public:
+		/**
+		 * @brief Store the next file to read in \a path. When \a wait is
+		 * false, return false right away if there is none yet; otherwise
+		 * wait for one, and return false once there are no more.
+		 */
+		typedef std::function<bool( QString* path, bool wait )> PathSource;
+
+		/**
+		 * @brief Receive the stamp of the file at \a path; return true if
+		 * its content is needed as well.
+		 */
+		typedef std::function<bool( const QString& path,
+									const ParseCache::FileStamp& stamp )> StampSink;
+
+		/**
+		 * @brief Receive the content of the file at \a path, valid until the
+		 * sink returns; \a data is null if the file cannot be read.
+		 */
+		typedef std::function<void( const QString& path,
+									const ParseCache::FileStamp& stamp,
+									const char* data, qint64 size )> ContentSink;
+
+		/**
+		 * @brief Set up a ring able to keep \a queueDepth files in flight.
+		 */
+		explicit BatchReader( int queueDepth = defaultQueueDepth() );
+		~BatchReader();
+
+		/**
+		 * @brief Return true if the ring has been set up and the running
+		 * kernel supports every operation it needs; false as well once
+		 * read() has failed.
+		 */
+		bool isValid() const { return _ring != 0; }
+
+		int queueDepth() const { return _queueDepth; }
+
+		/**
+		 * @brief Read every file provided by \a source until it runs out
+		 * or \a cancellation is raised.
+		 * @return False if the ring failed. Every file taken from \a source
+		 * so far has still been passed to the sinks, but the remaining ones
+		 * must be read the usual way.
+		 */
+		bool read( const PathSource& source, const StampSink& stampSink,
+				   const ContentSink& contentSink,
+				   const CancellationToken* cancellation = 0
+		);
+
+		/**
+		 * @brief Return true if io_uring can be used on this system.
+		 */
+		static bool isSupported();
+
+		static int defaultQueueDepth() { return 32; }
+		static int maxQueueDepth() { return 1024; }
+
+	private:
+		BatchReaderRing* _ring;
+		int _queueDepth;
+
+		Q_DISABLE_COPY( BatchReader )
+	};
+}
+
+#endif // BATCHREADER_H
@@ -0,0 +1,187 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * boundedqueue.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The BoundedQueue class is a thread safe FIFO queue holding at
+	 * most capacity() items, used to connect the stages of a pipeline.
+	 *
+	 * Producers block while the queue is full and consumers while it is
+	 * empty; every such wait is counted as a stall, so that the statistics
+	 * tell which side of the queue limits the throughput.
+	 */
+	template<typename T>
+	class BoundedQueue
+	{
+	public:
+		struct Statistics
+		{
+			Statistics()
+				: pushed( 0 ), maxDepth( 0 ),
+				  pushStalls( 0 ), pushStallNsecs( 0 ),
+				  popStalls( 0 ), popStallNsecs( 0 )
+			{}
+
+			qint64 pushed;
+			int maxDepth;
+			qint64 pushStalls;
+			qint64 pushStallNsecs;
+			qint64 popStalls;
+			qint64 popStallNsecs;
+		};
+
+		explicit BoundedQueue( int capacity )
+			: _capacity( qMax( 1, capacity ) ),
+			  _closed( false )
+		{}
+
+		int capacity() const { return _capacity; }
+
+		/**
+		 * @brief Append \a value, waiting for room if the queue is full.
+		 * @return False if the queue has been closed.
+		 */
+		bool push( const T& value )
+		{
+			QMutexLocker locker( &_mutex );
+			if( _items.count() >= _capacity && !_closed )
+			{
+				QElapsedTimer timer;
+				timer.start();
+				_stats.pushStalls++;
+
+				while( _items.count() >= _capacity && !_closed )
+					_notFull.wait( &_mutex );
+
+				_stats.pushStallNsecs += timer.nsecsElapsed();
+			}
+
+			if( _closed )
+				return false;
+
+			_items.enqueue( value );
+			_stats.pushed++;
+			_stats.maxDepth = qMax( _stats.maxDepth, _items.count() );
+			_notEmpty.wakeOne();
+			return true;
+		}
+
+		/**
+		 * @brief Take the oldest item, waiting for one if the queue is empty.
+		 * @return False once the queue is closed and empty.
+		 */
+		bool pop( T* value )
+		{
+			QMutexLocker locker( &_mutex );
+			if( _items.isEmpty() && !_closed )
+			{
+				QElapsedTimer timer;
+				timer.start();
+				_stats.popStalls++;
+
+				while( _items.isEmpty() && !_closed )
+					_notEmpty.wait( &_mutex );
+
+				_stats.popStallNsecs += timer.nsecsElapsed();
+			}
+
+			if( _items.isEmpty() )
+				return false;
+
+			*value = _items.dequeue();
+			_notFull.wakeOne();
+			return true;
+		}
+
+		/**
+		 * @brief Take the oldest item, if any, without waiting.
+		 */
+		bool tryPop( T* value )
+		{
+			QMutexLocker locker( &_mutex );
+			if( _items.isEmpty() )
+				return false;
+
+			*value = _items.dequeue();
+			_notFull.wakeOne();
+			return true;
+		}
+
+		/**
+		 * @brief Refuse any further item and wake up every waiting thread;
+		 * the items already queued can still be popped.
+		 */
+		void close()
+		{
+			QMutexLocker locker( &_mutex );
+			_closed = true;
+			_notEmpty.wakeAll();
+			_notFull.wakeAll();
+		}
+
+		Statistics statistics() const
+		{
+			QMutexLocker locker( &_mutex );
+			return _stats;
+		}
+
+	private:
+		mutable QMutex _mutex;
+		QWaitCondition _notEmpty;
+		QWaitCondition _notFull;
+		QQueue<T> _items;
+		const int _capacity;
+		bool _closed;
+		Statistics _stats;
+
+		Q_DISABLE_COPY( BoundedQueue )
+	};
+}
+
+#endif // BOUNDEDQUEUE_H
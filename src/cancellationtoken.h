@@ -0,0 +1,76 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * cancellationtoken.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#ifndef HELPERS_H
+#	include "helpers.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The CancellationToken class is a flag which the GUI thread
+	 * raises to ask background work to stop; workers poll it at convenient
+	 * points and return early.
+	 */
+	class CancellationToken
+	{
+	public:
+		CancellationToken() : _cancelled( 0 ) {}
+
+		void cancel() { Helpers::atomicStore( _cancelled, 1 ); }
+		void reset() { Helpers::atomicStore( _cancelled, 0 ); }
+		bool isCancelled() const { return Helpers::atomicLoad( _cancelled ) != 0; }
+
+		/**
+		 * @brief Return true if \a token is not null and has been cancelled.
+		 */
+		static bool isCancelled( const CancellationToken* token )
+		{
+			return token && token->isCancelled();
+		}
+
+	private:
+		QAtomicInt _cancelled;
+
+		Q_DISABLE_COPY( CancellationToken )
+	};
+}
+
+#endif // CANCELLATIONTOKEN_H
@@ -0,0 +1,512 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * compilationdatabase.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "compilationdatabase.h"
+#include "filereader.h"
+
+namespace depgraphV
+{
+	static inline bool _isJsonBlank( char c )
+	{
+		return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+	}
+
+	static inline const char* _skipJsonBlanks( const char* p, const char* end )
+	{
+		while( p < end && _isJsonBlank( *p ) )
+			++p;
+
+		return p;
+	}
+
+	static inline int _hexValue( char c )
+	{
+		if( c >= '0' && c <= '9' )
+			return c - '0';
+
+		if( c >= 'a' && c <= 'f' )
+			return c - 'a' + 10;
+
+		if( c >= 'A' && c <= 'F' )
+			return c - 'A' + 10;
+
+		return -1;
+	}
+
+	static const char* _readHex4( const char* p, const char* end, uint* value )
+	{
+		if( end - p < 4 )
+			return 0;
+
+		*value = 0;
+		for( int i = 0; i < 4; ++i )
+		{
+			int v = _hexValue( p[ i ] );
+			if( v < 0 )
+				return 0;
+
+			*value = ( *value << 4 ) | v;
+		}
+
+		return p + 4;
+	}
+
+	static void _appendUtf8( QByteArray* out, uint codePoint )
+	{
+		if( codePoint < 0x80 )
+			out->append( char( codePoint ) );
+		else if( codePoint < 0x800 )
+		{
+			out->append( char( 0xC0 | ( codePoint >> 6 ) ) );
+			out->append( char( 0x80 | ( codePoint & 0x3F ) ) );
+		}
+		else if( codePoint < 0x10000 )
+		{
+			out->append( char( 0xE0 | ( codePoint >> 12 ) ) );
+			out->append( char( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) ) );
+			out->append( char( 0x80 | ( codePoint & 0x3F ) ) );
+		}
+		else
+		{
+			out->append( char( 0xF0 | ( codePoint >> 18 ) ) );
+			out->append( char( 0x80 | ( ( codePoint >> 12 ) & 0x3F ) ) );
+			out->append( char( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) ) );
+			out->append( char( 0x80 | ( codePoint & 0x3F ) ) );
+		}
+	}
+
+	/**
+	 * Read the JSON string starting at \a p (which must point to its opening
+	 * quote) and store its UTF-8 decoded value in \a out, if not null.
+	 * Return the position following the closing quote, or null on errors.
+	 */
+	static const char* _readJsonString( const char* p, const char* end, QByteArray* out )
+	{
+		if( p >= end || *p != '"' )
+			return 0;
+
+		if( out )
+			out->clear();
+
+		const char* chunk = ++p;
+		for( ;; )
+		{
+			while( p < end && *p != '"' && *p != '\\' )
+				++p;
+
+			if( p >= end )
+				return 0;
+
+			if( out )
+				out->append( chunk, p - chunk );
+
+			if( *p == '"' )
+				return p + 1;
+
+			//Escape sequence
+			if( ++p >= end )
+				return 0;
+
+			char c = *p++;
+			uint codePoint = 0;
+			switch( c )
+			{
+				case '"': case '\\': case '/': codePoint = c; break;
+				case 'b': codePoint = '\b'; break;
+				case 'f': codePoint = '\f'; break;
+				case 'n': codePoint = '\n'; break;
+				case 'r': codePoint = '\r'; break;
+				case 't': codePoint = '\t'; break;
+				case 'u':
+					if( !( p = _readHex4( p, end, &codePoint ) ) )
+						return 0;
+
+					//Surrogate pair
+					if( codePoint >= 0xD800 && codePoint < 0xDC00 &&
+						end - p >= 6 && p[ 0 ] == '\\' && p[ 1 ] == 'u' )
+					{
+						uint low;
+						const char* next = _readHex4( p + 2, end, &low );
+						if( next && low >= 0xDC00 && low < 0xE000 )
+						{
+							codePoint = 0x10000 + ( ( codePoint - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+							p = next;
+						}
+					}
+					break;
+
+				default:
+					return 0;
+			}
+
+			if( out )
+				_appendUtf8( out, codePoint );
+
+			chunk = p;
+		}
+	}
+
+	/**
+	 * Skip the JSON value starting at \a p; return the position following it,
+	 * or null on errors.
+	 */
+	static const char* _skipJsonValue( const char* p, const char* end )
+	{
+		if( p >= end )
+			return 0;
+
+		if( *p == '"' )
+			return _readJsonString( p, end, 0 );
+
+		if( *p != '{' && *p != '[' )
+		{
+			//Number or literal
+			const char* start = p;
+			while( p < end && !_isJsonBlank( *p ) && *p != ',' && *p != ']' && *p != '}' )
+				++p;
+
+			return p > start ? p : 0;
+		}
+
+		//Objects and arrays: only nesting and strings matter to find the end
+		int depth = 0;
+		while( p < end )
+		{
+			char c = *p;
+			if( c == '"' )
+			{
+				if( !( p = _readJsonString( p, end, 0 ) ) )
+					return 0;
+
+				continue;
+			}
+
+			if( c == '{' || c == '[' )
+				depth++;
+			else if( ( c == '}' || c == ']' ) && --depth == 0 )
+				return p + 1;
+
+			++p;
+		}
+
+		return 0;
+	}
+	//-------------------------------------------------------------------------
+	CompilationDatabase::CompilationDatabase()
+		: _valid( false ),
+		  _entriesCount( 0 )
+	{
+	}
+	//-------------------------------------------------------------------------
+	bool CompilationDatabase::load( const QString& fileName )
+	{
+		*this = CompilationDatabase();
+
+		FileReader reader;
+		if( !reader.open( fileName ) )
+		{
+			_errorString = QCoreApplication::translate(
+							   "CompilationDatabase", "Unable to read \"%1\"."
+			).arg( fileName );
+			return false;
+		}
+
+		const char* begin = reader.data();
+		const char* end = begin + reader.size();
+		const char* p = begin;
+
+		//UTF-8 BOM
+		if( end - p >= 3 && p[ 0 ] == '\xEF' && p[ 1 ] == '\xBB' && p[ 2 ] == '\xBF' )
+			p += 3;
+
+		QByteArray key;
+		QByteArray value;
+		bool ok = false;
+
+		p = _skipJsonBlanks( p, end );
+		if( p < end && *p == '[' )
+		{
+			p = _skipJsonBlanks( p + 1, end );
+			ok = p < end && *p == ']';
+			while( p && p < end && !ok && *p == '{' )
+			{
+				QString directory;
+				QString file;
+				QString command;
+				QStringList arguments;
+				bool hasArguments = false;
+
+				p = _skipJsonBlanks( p + 1, end );
+				bool entryClosed = p < end && *p == '}';
+				while( p && p < end && !entryClosed )
+				{
+					if( !( p = _readJsonString( p, end, &key ) ) )
+						break;
+
+					p = _skipJsonBlanks( p, end );
+					if( p >= end || *p != ':' )
+					{
+						p = 0;
+						break;
+					}
+
+					p = _skipJsonBlanks( p + 1, end );
+					if( key == "directory" || key == "file" || key == "command" )
+					{
+						if( !( p = _readJsonString( p, end, &value ) ) )
+							break;
+
+						QString v = QString::fromUtf8( value.constData(), value.size() );
+						if( key == "directory" )
+							directory = v;
+						else if( key == "file" )
+							file = v;
+						else
+							command = v;
+					}
+					else if( key == "arguments" && p < end && *p == '[' )
+					{
+						hasArguments = true;
+						p = _skipJsonBlanks( p + 1, end );
+						while( p && p < end && *p != ']' )
+						{
+							if( !( p = _readJsonString( p, end, &value ) ) )
+								break;
+
+							arguments.append( QString::fromUtf8( value.constData(), value.size() ) );
+							p = _skipJsonBlanks( p, end );
+							if( p < end && *p == ',' )
+								p = _skipJsonBlanks( p + 1, end );
+						}
+
+						if( !p || p >= end )
+						{
+							p = 0;
+							break;
+						}
+
+						++p;
+					}
+					else if( !( p = _skipJsonValue( p, end ) ) )
+						break;
+
+					p = _skipJsonBlanks( p, end );
+					if( p < end && *p == ',' )
+						p = _skipJsonBlanks( p + 1, end );
+					else if( p < end && *p == '}' )
+						entryClosed = true;
+					else
+						p = 0;
+				}
+
+				if( !p || !entryClosed )
+				{
+					p = 0;
+					break;
+				}
+
+				_entriesCount++;
+				_addEntry( directory, file, hasArguments ? arguments : splitCommand( command ) );
+
+				p = _skipJsonBlanks( p + 1, end );
+				if( p < end && *p == ',' )
+					p = _skipJsonBlanks( p + 1, end );
+				else if( p < end && *p == ']' )
+					ok = true;
+				else
+					p = 0;
+			}
+		}
+
+		if( !ok )
+		{
+			_errorString = QCoreApplication::translate(
+							   "CompilationDatabase", "\"%1\" is not a valid "
+							   "compilation database (syntax error near byte %2)."
+			).arg( fileName ).arg( p ? p - begin : reader.size() );
+			return false;
+		}
+
+		_valid = true;
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	CompilationDatabase CompilationDatabase::fromFile( const QString& fileName )
+	{
+		CompilationDatabase db;
+		db.load( fileName );
+		return db;
+	}
+	//-------------------------------------------------------------------------
+	QStringList CompilationDatabase::includePaths() const
+	{
+		return _includePaths[ Quote ] + _includePaths[ Angled ] + _includePaths[ System ];
+	}
+	//-------------------------------------------------------------------------
+	QStringList CompilationDatabase::splitCommand( const QString& command )
+	{
+		QStringList result;
+		QString current;
+		bool inArgument = false;
+		const QChar* p = command.constData();
+		const QChar* end = p + command.length();
+
+		for( ; p < end; ++p )
+		{
+			QChar c = *p;
+			if( c == '\'' )
+			{
+				inArgument = true;
+				while( ++p < end && *p != '\'' )
+					current.append( *p );
+			}
+			else if( c == '"' )
+			{
+				inArgument = true;
+				while( ++p < end && *p != '"' )
+				{
+					if( *p == '\\' && p + 1 < end &&
+						( p[ 1 ] == '"' || p[ 1 ] == '\\' || p[ 1 ] == '$' || p[ 1 ] == '`' ) )
+						++p;
+
+					current.append( *p );
+				}
+			}
+			else if( c == '\\' && p + 1 < end )
+			{
+				inArgument = true;
+				current.append( *++p );
+			}
+			else if( c.isSpace() )
+			{
+				if( inArgument )
+				{
+					result.append( current );
+					current.clear();
+					inArgument = false;
+				}
+			}
+			else
+			{
+				inArgument = true;
+				current.append( c );
+			}
+
+			if( p >= end )
+				break;
+		}
+
+		if( inArgument )
+			result.append( current );
+
+		return result;
+	}
+	//-------------------------------------------------------------------------
+	void CompilationDatabase::_addEntry( const QString& directory,
+										 const QString& file,
+										 const QStringList& arguments )
+	{
+		if( file.isEmpty() )
+			return;
+
+		QString absFilePath = QDir::cleanPath( QDir::isRelativePath( file )
+											   ? directory + '/' + file
+											   : file
+		);
+		if( !_knownFiles.contains( absFilePath ) )
+		{
+			_knownFiles.insert( absFilePath );
+			_files.append( absFilePath );
+		}
+
+		//MSVC style "/I" options are only honored for cl-like compilers,
+		//since on other platforms they may well be paths
+		QString compiler = QFileInfo( arguments.value( 0 ) ).baseName().toLower();
+		bool msvc = compiler == "cl" || compiler == "clang-cl";
+
+		for( int i = 0; i < arguments.count(); ++i )
+		{
+			const QString& a = arguments[ i ];
+			PathKind kind;
+			int optionLength;
+			if( a.startsWith( "-I" ) || ( msvc && a.startsWith( "/I" ) ) )
+			{
+				kind = Angled;
+				optionLength = 2;
+			}
+			else if( a.startsWith( "-iquote" ) )
+			{
+				kind = Quote;
+				optionLength = 7;
+			}
+			else if( a.startsWith( "-isystem" ) )
+			{
+				kind = System;
+				optionLength = 8;
+			}
+			else if( a.startsWith( "-idirafter" ) )
+			{
+				kind = System;
+				optionLength = 10;
+			}
+			else
+				continue;
+
+			QString path = a.mid( optionLength );
+			if( path.isEmpty() && i + 1 < arguments.count() )
+				path = arguments[ ++i ];
+
+			if( !path.isEmpty() )
+				_addIncludePath( directory, path, kind );
+		}
+	}
+	//-------------------------------------------------------------------------
+	void CompilationDatabase::_addIncludePath( const QString& directory,
+											   const QString& path,
+											   PathKind kind )
+	{
+		QString absPath = QDir::cleanPath( QDir::isRelativePath( path )
+										   ? directory + '/' + path
+										   : path
+		);
+		if( _knownIncludePaths.contains( absPath ) )
+			return;
+
+		_knownIncludePaths.insert( absPath );
+		_includePaths[ kind ].append( absPath );
+	}
+}
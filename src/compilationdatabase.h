@@ -0,0 +1,132 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * compilationdatabase.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef COMPILATIONDATABASE_H
+#define COMPILATIONDATABASE_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The CompilationDatabase class reads a JSON compilation database
+	 * (compile_commands.json) and collects the translation units it lists,
+	 * along with the include directories passed to the compiler.
+	 *
+	 * The file is parsed in a single streaming pass, without building a
+	 * document tree; only the "directory", "file", "command" and "arguments"
+	 * members of each entry are decoded, everything else is skipped.
+	 */
+	class CompilationDatabase
+	{
+	public:
+		CompilationDatabase();
+
+		/**
+		 * @brief Read the compilation database in \a fileName.
+		 * @return False on I/O or syntax errors; see errorString().
+		 */
+		bool load( const QString& fileName );
+
+		/**
+		 * @brief Convenience function which loads \a fileName into a new
+		 * instance, suitable for QtConcurrent::run().
+		 */
+		static CompilationDatabase fromFile( const QString& fileName );
+
+		bool isValid() const { return _valid; }
+		const QString& errorString() const { return _errorString; }
+
+		/**
+		 * @brief Return the number of entries found in the database.
+		 */
+		int entriesCount() const { return _entriesCount; }
+
+		/**
+		 * @brief Return the absolute path of each translation unit, without
+		 * duplicates, in order of appearance.
+		 */
+		const QStringList& files() const { return _files; }
+
+		/**
+		 * @brief Return the absolute path of each include directory found in
+		 * any command, without duplicates: -iquote directories first, then
+		 * -I and finally -isystem and -idirafter ones, each group in order
+		 * of appearance.
+		 */
+		QStringList includePaths() const;
+
+		/**
+		 * @brief Split a shell command line into its arguments, honoring
+		 * quotes and backslash escapes.
+		 */
+		static QStringList splitCommand( const QString& command );
+
+	private:
+		enum PathKind
+		{
+			Quote,
+			Angled,
+			System
+		};
+
+		bool _valid;
+		QString _errorString;
+		int _entriesCount;
+
+		QStringList _files;
+		QSet<QString> _knownFiles;
+
+		QStringList _includePaths[ 3 ];
+		QSet<QString> _knownIncludePaths;
+
+		void _addEntry( const QString& directory, const QString& file,
+						const QStringList& arguments
+		);
+		void _addIncludePath( const QString& directory, const QString& path,
+							  PathKind kind
+		);
+	};
+}
+
+#endif // COMPILATIONDATABASE_H
@@ -0,0 +1,165 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * cyclefinder.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "cyclefinder.h"
+
+#include <algorithm>
+
+namespace depgraphV
+{
+	const quint32 CycleFinder::NoComponent = 0xffffffffu;
+
+	static const int CANCELLATION_CHECK_INTERVAL = 4096;
+
+	namespace
+	{
+		struct Frame
+		{
+			DependencyGraph::VertexId vertex;
+			DependencyGraph::EdgeId next;
+		};
+
+		bool largerFirst( const QVector<DependencyGraph::VertexId>& a,
+						  const QVector<DependencyGraph::VertexId>& b )
+		{
+			return a.count() > b.count();
+		}
+	}
+
+	CycleFinder::CycleFinder()
+	{
+		clear();
+	}
+	//-------------------------------------------------------------------------
+	bool CycleFinder::run( const DependencyGraph& graph,
+						   const CancellationToken* cancellation )
+	{
+		Q_ASSERT( graph.isCompact() );
+		QElapsedTimer timer;
+		timer.start();
+		clear();
+
+		const int count = graph.vertexCount();
+		const quint32 unvisited = 0xffffffffu;
+		QVector<quint32> order( count, unvisited );
+		QVector<quint32> lowLink( count );
+		QVector<VertexId> stack;
+		QVector<Frame> calls;
+		quint32 visited = 0;
+		_components.fill( NoComponent, count );
+
+		for( VertexId root = 0; root < VertexId( count ); ++root )
+		{
+			if( order.at( root ) != unvisited )
+				continue;
+
+			if( root % CANCELLATION_CHECK_INTERVAL == 0 &&
+					CancellationToken::isCancelled( cancellation ) )
+			{
+				clear();
+				return false;
+			}
+
+			order[ root ] = lowLink[ root ] = visited++;
+			stack.append( root );
+			Frame first = { root, graph.outBegin( root ) };
+			calls.append( first );
+
+			while( !calls.isEmpty() )
+			{
+				const VertexId v = calls.last().vertex;
+				if( calls.last().next < graph.outEnd( v ) )
+				{
+					const VertexId w = graph.target( calls.last().next++ );
+					if( order.at( w ) == unvisited )
+					{
+						order[ w ] = lowLink[ w ] = visited++;
+						stack.append( w );
+						Frame call = { w, graph.outBegin( w ) };
+						calls.append( call );
+					}
+					//Visited vertices without a component are on the stack
+					else if( _components.at( w ) == NoComponent )
+						lowLink[ v ] = qMin( lowLink.at( v ), order.at( w ) );
+
+					continue;
+				}
+
+				calls.removeLast();
+				if( !calls.isEmpty() )
+				{
+					const VertexId caller = calls.last().vertex;
+					lowLink[ caller ] = qMin( lowLink.at( caller ), lowLink.at( v ) );
+				}
+
+				if( lowLink.at( v ) != order.at( v ) )
+					continue;
+
+				//v is the root of a component: its members are above it
+				int first = stack.count() - 1;
+				while( stack.at( first ) != v )
+					--first;
+
+				const quint32 component = _componentCount++;
+				for( int i = first; i < stack.count(); ++i )
+					_components[ stack.at( i ) ] = component;
+
+				const int size = stack.count() - first;
+				const bool cyclic = size > 1 ||
+						graph.findEdge( v, v ) != DependencyGraph::EdgeId( graph.edgeCount() );
+				_cyclic.append( cyclic );
+				if( cyclic )
+					_cycles.append( stack.mid( first ) );
+
+				stack.resize( first );
+			}
+		}
+
+		std::stable_sort( _cycles.begin(), _cycles.end(), largerFirst );
+		_elapsed = timer.elapsed();
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	void CycleFinder::clear()
+	{
+		_components.clear();
+		_cyclic.clear();
+		_componentCount = 0;
+		_cycles.clear();
+		_elapsed = 0;
+	}
+}
@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * cyclefinder.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef CYCLEFINDER_H
+#define CYCLEFINDER_H
+
+#ifndef DEPENDENCYGRAPH_H
+#	include "dependencygraph.h"
+#endif
+
+#ifndef CANCELLATIONTOKEN_H
+#	include "cancellationtoken.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The CycleFinder class finds the include cycles of a
+	 * DependencyGraph, as its strongly connected components.
+	 *
+	 * It runs Tarjan's algorithm, in O(V + E), with an explicit stack of
+	 * (vertex, next edge) frames instead of recursion, so that long include
+	 * chains cannot overflow the thread stack.
+	 */
+	class CycleFinder
+	{
+	public:
+		typedef DependencyGraph::VertexId VertexId;
+
+		//Component of the vertices not visited yet
+		static const quint32 NoComponent;
+
+		CycleFinder();
+
+		/**
+		 * @brief Find the strongly connected components of \a graph, which
+		 * must be compact.
+		 * @return False if \a cancellation has been cancelled meanwhile; the
+		 * results are cleared then.
+		 */
+		bool run( const DependencyGraph& graph,
+				  const CancellationToken* cancellation = 0 );
+
+		/**
+		 * @brief Return the components which make up a cycle (more than one
+		 * vertex, or a vertex including itself), largest first.
+		 */
+		const QList<QVector<VertexId> >& cycles() const { return _cycles; }
+
+		/**
+		 * @brief Return the component of \a v.
+		 */
+		quint32 component( VertexId v ) const { return _components.at( v ); }
+		int componentCount() const { return _componentCount; }
+
+		/**
+		 * @brief Return true if \a v is part of a cycle.
+		 */
+		bool inCycle( VertexId v ) const { return _cyclic.at( _components.at( v ) ); }
+
+		/**
+		 * @brief Return how many milliseconds the last run() took.
+		 */
+		qint64 elapsed() const { return _elapsed; }
+
+		void clear();
+
+	private:
+		QVector<quint32> _components;
+		QVector<bool> _cyclic;
+		int _componentCount;
+		QList<QVector<VertexId> > _cycles;
+		qint64 _elapsed;
+	};
+}
+
+#endif // CYCLEFINDER_H
@@ -0,0 +1,361 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * dependencygraph.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "dependencygraph.h"
+
+#include <algorithm>
+
+namespace depgraphV
+{
+	const DependencyGraph::VertexId DependencyGraph::NoVertex = 0xffffffffu;
+
+	static const int INITIAL_PENDING_SLOTS = 64;
+
+	namespace
+	{
+		struct CountedEdge
+		{
+			quint64 edge;
+			quint32 multiplicity;
+
+			bool operator<( const CountedEdge& other ) const { return edge < other.edge; }
+		};
+	}
+
+	DependencyGraph::DependencyGraph()
+	{
+		clear();
+	}
+	//-------------------------------------------------------------------------
+	DependencyGraph::VertexId DependencyGraph::addVertex( const QString& name, const QString& label )
+	{
+		bool added;
+		const VertexId v = _names.intern( name, &added );
+		if( added && !label.isEmpty() && label != name )
+			setVertexAttribute( v, "label", label );
+
+		return v;
+	}
+	//-------------------------------------------------------------------------
+	DependencyGraph::VertexId DependencyGraph::vertex( const QString& name ) const
+	{
+		//StringInterner::NoString and NoVertex are both all ones
+		return _names.find( name );
+	}
+	//-------------------------------------------------------------------------
+	bool DependencyGraph::addEdge( VertexId source, VertexId target )
+	{
+		Q_ASSERT( source < VertexId( _names.count() ) && target < VertexId( _names.count() ) );
+
+		//Vertices added after the last compact() have no row yet
+		if( source + 1 < VertexId( _outOffsets.count() ) )
+		{
+			const EdgeId e = _findCompacted( source, target );
+			if( e != EdgeId( _outTargets.count() ) )
+			{
+				++_multiplicities[ e ];
+				++_mergedEdges;
+				return false;
+			}
+		}
+
+		const quint64 edge = ( quint64( source ) << 32 ) | target;
+		const int mask = _pendingSlots.count() - 1;
+		int i = int( _hash( edge ) ) & mask;
+		for( ; _pendingSlots.at( i ) != NoVertex; i = ( i + 1 ) & mask )
+		{
+			const quint32 index = _pendingSlots.at( i );
+			if( _pendingEdges.at( index ) == edge )
+			{
+				++_pendingMultiplicities[ index ];
+				++_mergedEdges;
+				return false;
+			}
+		}
+
+		_pendingSlots[ i ] = _pendingEdges.count();
+		_pendingEdges.append( edge );
+		_pendingMultiplicities.append( 1 );
+		if( _pendingEdges.count() * 2 > _pendingSlots.count() )
+			_rehashPendingSlots( _pendingSlots.count() * 2 );
+
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	void DependencyGraph::reserve( int vertices, int edges )
+	{
+		_names.reserve( _names.count() + vertices );
+
+		const int count = _pendingEdges.count() + edges;
+		_pendingEdges.reserve( count );
+		_pendingMultiplicities.reserve( count );
+
+		int slotCount = _pendingSlots.count();
+		while( count * 2 > slotCount )
+			slotCount *= 2;
+
+		if( slotCount != _pendingSlots.count() )
+			_rehashPendingSlots( slotCount );
+	}
+	//-------------------------------------------------------------------------
+	bool DependencyGraph::isCompact() const
+	{
+		return _pendingEdges.isEmpty() && _outOffsets.count() == _names.count() + 1;
+	}
+	//-------------------------------------------------------------------------
+	void DependencyGraph::compact()
+	{
+		if( isCompact() )
+			return;
+
+		//Merge the compacted edges with the pending ones, which are all
+		//distinct, and sort them by source, then by target
+		QVector<CountedEdge> edges;
+		edges.reserve( edgeCount() );
+		for( VertexId v = 0; v + 1 < VertexId( _outOffsets.count() ); ++v )
+		{
+			for( EdgeId e = outBegin( v ); e < outEnd( v ); ++e )
+			{
+				CountedEdge c = { ( quint64( v ) << 32 ) | _outTargets.at( e ),
+								  _multiplicities.at( e ) };
+				edges.append( c );
+			}
+		}
+
+		if( !_pendingEdges.isEmpty() )
+			_edgeColumns.clear();
+
+		for( int i = 0; i < _pendingEdges.count(); ++i )
+		{
+			CountedEdge c = { _pendingEdges.at( i ), _pendingMultiplicities.at( i ) };
+			edges.append( c );
+		}
+
+		_pendingEdges.clear();
+		_pendingEdges.squeeze();
+		_pendingMultiplicities.clear();
+		_pendingMultiplicities.squeeze();
+		_pendingSlots.fill( NoVertex, INITIAL_PENDING_SLOTS );
+		_pendingSlots.squeeze();
+		std::sort( edges.begin(), edges.end() );
+
+		const int vertices = _names.count();
+		const int count = edges.count();
+		_outOffsets.fill( 0, vertices + 1 );
+		_inOffsets.fill( 0, vertices + 1 );
+		_outTargets.resize( count );
+		_multiplicities.resize( count );
+		_inSources.resize( count );
+
+		for( int i = 0; i < count; ++i )
+		{
+			++_outOffsets[ ( edges.at( i ).edge >> 32 ) + 1 ];
+			++_inOffsets[ quint32( edges.at( i ).edge ) + 1 ];
+		}
+
+		for( int v = 0; v < vertices; ++v )
+		{
+			_outOffsets[ v + 1 ] += _outOffsets.at( v );
+			_inOffsets[ v + 1 ] += _inOffsets.at( v );
+		}
+
+		//Edges are visited by increasing source, so incoming rows end up
+		//sorted as well
+		QVector<quint32> next( _inOffsets );
+		for( int i = 0; i < count; ++i )
+		{
+			const VertexId source = edges.at( i ).edge >> 32;
+			const VertexId target = quint32( edges.at( i ).edge );
+			_outTargets[ i ] = target;
+			_multiplicities[ i ] = edges.at( i ).multiplicity;
+			_inSources[ next[ target ]++ ] = source;
+		}
+	}
+	//-------------------------------------------------------------------------
+	void DependencyGraph::clear()
+	{
+		_names.clear();
+		_values.clear();
+		_pendingEdges.clear();
+		_pendingMultiplicities.clear();
+		_pendingSlots.fill( NoVertex, INITIAL_PENDING_SLOTS );
+		_mergedEdges = 0;
+		_outTargets.clear();
+		_multiplicities.clear();
+		_inSources.clear();
+		_outOffsets.fill( 0, 1 );
+		_inOffsets.fill( 0, 1 );
+		_vertexColumns.clear();
+		_edgeColumns.clear();
+	}
+	//-------------------------------------------------------------------------
+	QString DependencyGraph::label( VertexId v ) const
+	{
+		const QString l = vertexAttribute( v, "label" );
+		return l.isEmpty() ? name( v ) : l;
+	}
+	//-------------------------------------------------------------------------
+	DependencyGraph::EdgeId DependencyGraph::findEdge( VertexId source, VertexId target ) const
+	{
+		Q_ASSERT( isCompact() );
+		return _findCompacted( source, target );
+	}
+	//-------------------------------------------------------------------------
+	DependencyGraph::VertexId DependencyGraph::edgeSource( EdgeId e ) const
+	{
+		Q_ASSERT( isCompact() && e < EdgeId( _outTargets.count() ) );
+		//The last row starting at or before e; empty rows share its offset
+		const EdgeId* offsets = _outOffsets.constData();
+		const EdgeId* row = std::upper_bound( offsets, offsets + _outOffsets.count(), e );
+		return VertexId( row - offsets - 1 );
+	}
+	//-------------------------------------------------------------------------
+	DependencyGraph::EdgeId DependencyGraph::_findCompacted( VertexId source,
+															 VertexId target ) const
+	{
+		const VertexId* row = _outTargets.constData();
+		const VertexId* last = row + outEnd( source );
+		const VertexId* e = std::lower_bound( row + outBegin( source ), last, target );
+
+		return e != last && *e == target ? EdgeId( e - row ) : EdgeId( _outTargets.count() );
+	}
+	//-------------------------------------------------------------------------
+	void DependencyGraph::setVertexAttribute( VertexId v, const QString& name, const QString& value )
+	{
+		_setValue( &_vertexColumns, v, _names.count(), name, value );
+	}
+	//-------------------------------------------------------------------------
+	QString DependencyGraph::vertexAttribute( VertexId v, const QString& name ) const
+	{
+		return _value( _vertexColumns, v, name );
+	}
+	//-------------------------------------------------------------------------
+	void DependencyGraph::setEdgeAttribute( EdgeId e, const QString& name, const QString& value )
+	{
+		Q_ASSERT( isCompact() );
+		_setValue( &_edgeColumns, e, _outTargets.count(), name, value );
+	}
+	//-------------------------------------------------------------------------
+	QString DependencyGraph::edgeAttribute( EdgeId e, const QString& name ) const
+	{
+		return _value( _edgeColumns, e, name );
+	}
+	//-------------------------------------------------------------------------
+	const QVector<StringInterner::Id>* DependencyGraph::vertexColumn( const QString& name ) const
+	{
+		Columns::const_iterator it = _vertexColumns.constFind( name );
+		return it != _vertexColumns.constEnd() ? &it.value() : 0;
+	}
+	//-------------------------------------------------------------------------
+	const QVector<StringInterner::Id>* DependencyGraph::edgeColumn( const QString& name ) const
+	{
+		Columns::const_iterator it = _edgeColumns.constFind( name );
+		return it != _edgeColumns.constEnd() ? &it.value() : 0;
+	}
+	//-------------------------------------------------------------------------
+	qint64 DependencyGraph::adjacencyBytes() const
+	{
+		return qint64( _outOffsets.capacity() + _outTargets.capacity() +
+					   _multiplicities.capacity() + _inOffsets.capacity() +
+					   _inSources.capacity() + _pendingMultiplicities.capacity() +
+					   _pendingSlots.capacity() ) * sizeof( quint32 ) +
+				qint64( _pendingEdges.capacity() ) * sizeof( quint64 );
+	}
+	//-------------------------------------------------------------------------
+	quint32 DependencyGraph::_hash( quint64 edge )
+	{
+		//Fibonacci hashing: the high bits of the product mix all of the
+		//bits of both ids
+		return quint32( ( edge * Q_UINT64_C( 0x9e3779b97f4a7c15 ) ) >> 32 );
+	}
+	//-------------------------------------------------------------------------
+	void DependencyGraph::_rehashPendingSlots( int slotCount )
+	{
+		_pendingSlots.fill( NoVertex, slotCount );
+		const int mask = _pendingSlots.count() - 1;
+		for( int index = 0; index < _pendingEdges.count(); ++index )
+		{
+			int i = int( _hash( _pendingEdges.at( index ) ) ) & mask;
+			while( _pendingSlots.at( i ) != NoVertex )
+				i = ( i + 1 ) & mask;
+
+			_pendingSlots[ i ] = index;
+		}
+	}
+	//-------------------------------------------------------------------------
+	qint64 DependencyGraph::stringBytes() const
+	{
+		qint64 result = _names.bytes() + _values.bytes();
+		foreach( const QVector<StringInterner::Id>& column, _vertexColumns )
+			result += qint64( column.capacity() ) * sizeof( StringInterner::Id );
+
+		foreach( const QVector<StringInterner::Id>& column, _edgeColumns )
+			result += qint64( column.capacity() ) * sizeof( StringInterner::Id );
+
+		return result;
+	}
+	//-------------------------------------------------------------------------
+	void DependencyGraph::_setValue( Columns* columns, quint32 index, int count,
+									 const QString& name, const QString& value )
+	{
+		QVector<StringInterner::Id>& column = ( *columns )[ name ];
+		if( column.count() <= int( index ) )
+		{
+			if( value.isEmpty() )
+				return;
+
+			const int previous = column.count();
+			column.resize( count );
+			for( int i = previous; i < count; ++i )
+				column[ i ] = StringInterner::NoString;
+		}
+
+		column[ index ] = value.isEmpty() ? StringInterner::NoString
+										  : _values.intern( value );
+	}
+	//-------------------------------------------------------------------------
+	QString DependencyGraph::_value( const Columns& columns, quint32 index,
+									 const QString& name ) const
+	{
+		Columns::const_iterator it = columns.constFind( name );
+		if( it == columns.constEnd() || it.value().count() <= int( index ) ||
+				it.value().at( index ) == StringInterner::NoString )
+			return QString();
+
+		return _values.string( it.value().at( index ) );
+	}
+}
@@ -0,0 +1,254 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * dependencygraph.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef DEPENDENCYGRAPH_H
+#define DEPENDENCYGRAPH_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+#ifndef STRINGINTERNER_H
+#	include "stringinterner.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The DependencyGraph class is the in-memory model of a dependency
+	 * graph, independent from GraphViz: the GraphViz graph is generated from
+	 * it only when a layout is needed, and analyses can run on it from any
+	 * thread, as long as nothing modifies it meanwhile.
+	 *
+	 * Vertices are identified by the ids of their interned names. Edges are
+	 * first appended to a pending list; compact() sorts them into CSR
+	 * (compressed sparse row) arrays, one for outgoing edges and one for
+	 * incoming ones, so that an edge costs 4 bytes in each direction. Edge
+	 * ids are indices in the outgoing array, which lists the targets of
+	 * each vertex sorted by id.
+	 *
+	 * A (source, target) pair is stored once: adding it again only counts
+	 * one more occurrence, its multiplicity. Pending pairs are found through
+	 * an open addressing table of packed ids, compacted ones by a binary
+	 * search in their row.
+	 *
+	 * Vertex and edge attributes are stored by column: one vector of
+	 * interned values for each attribute name.
+	 */
+	class DependencyGraph
+	{
+	public:
+		typedef quint32 VertexId;
+		typedef quint32 EdgeId;
+
+		//Returned by vertex() for unknown names
+		static const VertexId NoVertex;
+
+		DependencyGraph();
+
+		/**
+		 * @brief Return the id of the vertex named \a name, adding it if it
+		 * does not exist yet.
+		 * @param label Shown instead of the name, if not empty; only used
+		 * when the vertex is added.
+		 */
+		VertexId addVertex( const QString& name, const QString& label = QString() );
+
+		/**
+		 * @brief Return the id of the vertex named \a name, or NoVertex.
+		 */
+		VertexId vertex( const QString& name ) const;
+
+		/**
+		 * @brief Add an edge from \a source to \a target, pending until the
+		 * next compact(), or increase its multiplicity if it exists.
+		 * @return True if the edge is new.
+		 */
+		bool addEdge( VertexId source, VertexId target );
+
+		/**
+		 * @brief Make room for \a vertices more vertices and \a edges more
+		 * pending edges.
+		 */
+		void reserve( int vertices, int edges );
+
+		/**
+		 * @brief Sort the pending edges into the CSR arrays; edge attributes
+		 * are dropped if there were pending edges, since edge ids change.
+		 */
+		void compact();
+
+		/**
+		 * @brief Return true if there are no pending edges, so that the
+		 * adjacency accessors can be used.
+		 */
+		bool isCompact() const;
+
+		/**
+		 * @brief Remove every vertex, edge and attribute.
+		 */
+		void clear();
+
+		int vertexCount() const { return _names.count(); }
+
+		/**
+		 * @brief Return the number of distinct edges, pending ones included.
+		 */
+		int edgeCount() const { return _outTargets.count() + _pendingEdges.count(); }
+
+		/**
+		 * @brief Return how many times addEdge() found an existing edge.
+		 */
+		int mergedEdges() const { return _mergedEdges; }
+
+		QString name( VertexId v ) const { return _names.string( v ); }
+
+		/**
+		 * @brief Return the name of \a v as NUL terminated UTF-8.
+		 */
+		const char* utf8Name( VertexId v ) const { return _names.utf8( v ); }
+
+		/**
+		 * @brief Return the label of \a v, which is its name unless another
+		 * label has been given.
+		 */
+		QString label( VertexId v ) const;
+
+		//Adjacency, valid while the graph is compact
+		EdgeId outBegin( VertexId v ) const { return _outOffsets.at( v ); }
+		EdgeId outEnd( VertexId v ) const { return _outOffsets.at( v + 1 ); }
+		VertexId target( EdgeId e ) const { return _outTargets.at( e ); }
+		int outDegree( VertexId v ) const { return outEnd( v ) - outBegin( v ); }
+
+		/**
+		 * @brief Return the source of the edge \a e, found by a binary
+		 * search in the row offsets.
+		 */
+		VertexId edgeSource( EdgeId e ) const;
+
+		/**
+		 * @brief Return how many times the edge \a e has been added.
+		 */
+		quint32 multiplicity( EdgeId e ) const { return _multiplicities.at( e ); }
+
+		quint32 inBegin( VertexId v ) const { return _inOffsets.at( v ); }
+		quint32 inEnd( VertexId v ) const { return _inOffsets.at( v + 1 ); }
+		VertexId source( quint32 i ) const { return _inSources.at( i ); }
+		int inDegree( VertexId v ) const { return inEnd( v ) - inBegin( v ); }
+
+		/**
+		 * @brief Return the first edge from \a source to \a target, or
+		 * edgeCount() if there is none.
+		 */
+		EdgeId findEdge( VertexId source, VertexId target ) const;
+
+		void setVertexAttribute( VertexId v, const QString& name, const QString& value );
+		QString vertexAttribute( VertexId v, const QString& name ) const;
+
+		/**
+		 * @brief Set an attribute of \a e; the graph must be compact.
+		 */
+		void setEdgeAttribute( EdgeId e, const QString& name, const QString& value );
+		QString edgeAttribute( EdgeId e, const QString& name ) const;
+
+		QStringList vertexAttributeNames() const { return _vertexColumns.keys(); }
+		QStringList edgeAttributeNames() const { return _edgeColumns.keys(); }
+
+		/**
+		 * @brief Return the values of the vertex attribute \a name by vertex
+		 * id, as ids in values(), or null; it may be shorter than
+		 * vertexCount(), and unset values are StringInterner::NoString.
+		 */
+		const QVector<StringInterner::Id>* vertexColumn( const QString& name ) const;
+		const QVector<StringInterner::Id>* edgeColumn( const QString& name ) const;
+
+		/**
+		 * @brief Return the attribute values referenced by the columns.
+		 */
+		const StringInterner& values() const { return _values; }
+
+		/**
+		 * @brief Return the approximate number of bytes used by the
+		 * adjacency arrays.
+		 */
+		qint64 adjacencyBytes() const;
+
+		/**
+		 * @brief Return the approximate number of bytes used by the vertex
+		 * names and the attributes.
+		 */
+		qint64 stringBytes() const;
+
+	private:
+		typedef QHash<QString, QVector<StringInterner::Id> > Columns;
+
+		static quint32 _hash( quint64 edge );
+		EdgeId _findCompacted( VertexId source, VertexId target ) const;
+		void _rehashPendingSlots( int slotCount );
+
+		void _setValue( Columns* columns, quint32 index, int count,
+						const QString& name, const QString& value );
+		QString _value( const Columns& columns, quint32 index,
+						const QString& name ) const;
+
+		StringInterner _names;
+		StringInterner _values;
+
+		//Packed ( source << 32 ) | target
+		QVector<quint64> _pendingEdges;
+		QVector<quint32> _pendingMultiplicities;
+		//Power of two sized, at most half full; indices in _pendingEdges,
+		//free slots hold NoVertex
+		QVector<quint32> _pendingSlots;
+		int _mergedEdges;
+
+		QVector<EdgeId> _outOffsets;
+		QVector<VertexId> _outTargets;
+		QVector<quint32> _multiplicities;
+		QVector<quint32> _inOffsets;
+		QVector<VertexId> _inSources;
+
+		Columns _vertexColumns;
+		Columns _edgeColumns;
+	};
+}
+
+#endif // DEPENDENCYGRAPH_H
@@ -48,15 +48,19 @@
 #include <QAction>
 #include <QActionGroup>
 #include <QApplication>
+#include <QAtomicInt>
 #include <QCheckBox>
 #include <QComboBox>
+#include <QDataStream>
 #include <QDataWidgetMapper>
 #include <QDebug>
 #include <QDesktopServices>
 #include <QDesktopWidget>
 #include <QDialog>
 #include <QDir>
+#include <QDirIterator>
 #include <QDoubleSpinBox>
+#include <QElapsedTimer>
 #include <QEvent>
 #include <QFile>
 #include <QFileDialog>
@@ -65,6 +69,7 @@
 #include <qglobal.h>
 #include <QGraphicsSvgItem>
 #include <QGraphicsView>
+#include <QHash>
 #include <QImageReader>
 #include <QInputDialog>
 #include <QItemDelegate>
@@ -78,25 +83,39 @@
 #include <QMetaEnum>
 #include <QMetaProperty>
 #include <QModelIndex>
+#include <QMutex>
 #include <QNetworkReply>
 #include <QObject>
 #include <QPlainTextEdit>
 #include <QProgressBar>
 #include <QPushButton>
+#include <QQueue>
 #include <QRadioButton>
+#include <QReadWriteLock>
+#include <QRunnable>
+#include <QSet>
 #include <QSettings>
+#include <QSharedPointer>
 #include <QSpinBox>
 #include <QStandardItemModel>
 #include <QStringList>
 #include <QSvgRenderer>
 #include <QTabBar>
 #include <QTabWidget>
+#include <QtEndian>
 #include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <QTimer>
 #include <QToolBar>
+#include <QToolButton>
 #include <QTranslator>
 #include <QTreeView>
 #include <QUrl>
+#include <QVarLengthArray>
 #include <QVector>
+#include <QWaitCondition>
 #include <QWheelEvent>
 #include <QWidget>
 #include <QXmlStreamReader>
@@ -105,6 +124,10 @@
 #	include <QGLWidget>
 #endif
 
+#if( QT_VERSION >= QT_VERSION_CHECK( 5, 0, 0 ) )
+#	include <QStandardPaths>
+#endif
+
 #ifndef QT_NO_CONCURRENT
 #	if( QT_VERSION >= QT_VERSION_CHECK( 5, 0, 0 ) )
 #		include <QtConcurrent>
@@ -134,8 +157,19 @@
 #ifdef WIN32
 #	define WIN32_LEAN_AND_MEAN
 #	include <windows.h>
+#else
+#	include <sys/resource.h>
+#	include <sys/stat.h>
+#	ifdef Q_OS_LINUX
+#		include <dirent.h>
+#		include <fcntl.h>
+#		include <sys/syscall.h>
+#		include <sys/wait.h>
+#		include <unistd.h>
+#	endif
 #endif
 
+#include <algorithm>
 #include <type_traits>
 #include <functional>
 #include <sstream>
@@ -0,0 +1,402 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * excluderules.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "excluderules.h"
+
+namespace depgraphV
+{
+	ExcludeRules::ExcludeRules()
+		: _hasNegations( false )
+	{
+	}
+	//-------------------------------------------------------------------------
+	ExcludeRules::ExcludeRules( const QStringList& patterns )
+		: _hasNegations( false )
+	{
+		foreach( QString pattern, patterns )
+			addPattern( pattern );
+	}
+	//-------------------------------------------------------------------------
+	bool ExcludeRules::loadGitignore( const QString& fileName )
+	{
+		QFile f( fileName );
+		if( !f.open( QIODevice::ReadOnly ) )
+			return false;
+
+		foreach( QByteArray line, f.readAll().split( '\n' ) )
+			addPattern( QString::fromUtf8( line ) );
+
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	void ExcludeRules::addPattern( const QString& pattern )
+	{
+		//Trailing blanks are not part of the pattern, leading ones are
+		QString p = pattern;
+		while( !p.isEmpty() && p.at( p.length() - 1 ).isSpace() )
+			p.chop( 1 );
+
+		if( p.isEmpty() || p.startsWith( '#' ) )
+			return;
+
+		Rule rule;
+		rule.negated = p.startsWith( '!' );
+		if( rule.negated )
+			p.remove( 0, 1 );
+		else if( p.startsWith( "\\!" ) || p.startsWith( "\\#" ) )
+			p.remove( 0, 1 );
+
+		rule.folderOnly = p.endsWith( '/' );
+		if( rule.folderOnly )
+			p.chop( 1 );
+
+		rule.anchored = p.contains( '/' );
+		if( p.startsWith( '/' ) )
+			p.remove( 0, 1 );
+		else if( p.startsWith( "**/" ) && !p.mid( 3 ).contains( '/' ) )
+		{
+			//"**/name" is the same as "name"
+			p.remove( 0, 3 );
+			rule.anchored = false;
+		}
+
+		if( p.isEmpty() )
+			return;
+
+		static const QRegExp wildcards( "[*?\\[\\\\]" );
+		const int wildcard = p.indexOf( wildcards );
+		const QString tail = p.mid( 1 );
+		const QString head = p.left( p.length() - 1 );
+
+		rule.text = p;
+		if( wildcard < 0 )
+			rule.kind = Literal;
+		else if( !rule.anchored && p.startsWith( '*' ) && tail.indexOf( wildcards ) < 0 )
+		{
+			rule.kind = Suffix;
+			rule.text = tail;
+		}
+		else if( !rule.anchored && p.endsWith( '*' ) && head.indexOf( wildcards ) < 0 )
+		{
+			rule.kind = Prefix;
+			rule.text = head;
+		}
+		else
+		{
+			rule.kind = Glob;
+			rule.tokens = _compileGlob( p );
+		}
+
+		const int index = _rules.count();
+		_rules.append( rule );
+		_hasNegations |= rule.negated;
+
+		if( rule.anchored )
+		{
+			_anchored.append( index );
+			return;
+		}
+
+		if( rule.negated )
+			return;
+
+		const int table = rule.folderOnly ? 1 : 0;
+		switch( rule.kind )
+		{
+		case Literal:
+			_literals[ table ].insert( rule.text );
+			break;
+		case Prefix:
+			_prefixes[ table ].append( rule.text );
+			break;
+		case Suffix:
+			_suffixes[ table ].append( rule.text );
+			break;
+		case Glob:
+			_globs.append( index );
+			break;
+		}
+	}
+	//-------------------------------------------------------------------------
+	ExcludeRules::Match ExcludeRules::match( const QString& relativePath,
+											 const QString& name, bool isFolder ) const
+	{
+		if( _hasNegations )
+		{
+			//The last matching pattern decides
+			for( int i = _rules.count() - 1; i >= 0; i-- )
+			{
+				const Rule& rule = _rules[ i ];
+				if( _matches( rule, relativePath, name, isFolder ) )
+					return rule.negated ? Included : Excluded;
+			}
+
+			return NoMatch;
+		}
+
+		const int tables = isFolder ? 2 : 1;
+		for( int t = 0; t < tables; t++ )
+		{
+			if( _literals[ t ].contains( name ) )
+				return Excluded;
+
+			foreach( const QString& prefix, _prefixes[ t ] )
+			{
+				if( name.startsWith( prefix ) )
+					return Excluded;
+			}
+
+			foreach( const QString& suffix, _suffixes[ t ] )
+			{
+				if( name.endsWith( suffix ) )
+					return Excluded;
+			}
+		}
+
+		foreach( int index, _globs )
+		{
+			if( _matches( _rules[ index ], relativePath, name, isFolder ) )
+				return Excluded;
+		}
+
+		foreach( int index, _anchored )
+		{
+			if( _matches( _rules[ index ], relativePath, name, isFolder ) )
+				return Excluded;
+		}
+
+		return NoMatch;
+	}
+	//-------------------------------------------------------------------------
+	QStringList ExcludeRules::splitPatterns( const QString& patterns )
+	{
+		QStringList result;
+		foreach( QString p, patterns.split( ';', QString::SkipEmptyParts ) )
+		{
+			p = p.trimmed();
+			if( !p.isEmpty() )
+				result.append( p );
+		}
+
+		return result;
+	}
+	//-------------------------------------------------------------------------
+	bool ExcludeRules::_matches( const Rule& rule, const QString& relativePath,
+								 const QString& name, bool isFolder ) const
+	{
+		if( rule.folderOnly && !isFolder )
+			return false;
+
+		const QString& subject = rule.anchored ? relativePath : name;
+		switch( rule.kind )
+		{
+		case Literal:
+			return subject == rule.text;
+		case Prefix:
+			return subject.startsWith( rule.text );
+		case Suffix:
+			return subject.endsWith( rule.text );
+		case Glob:
+			return _matchGlob( rule.tokens, subject );
+		}
+
+		return false;
+	}
+	//-------------------------------------------------------------------------
+	QVector<ExcludeRules::Token> ExcludeRules::_compileGlob( const QString& glob )
+	{
+		QVector<Token> tokens;
+		const int length = glob.length();
+
+		for( int i = 0; i < length; i++ )
+		{
+			Token token;
+			token.type = Char;
+			token.c = glob[ i ];
+			token.negatedClass = false;
+
+			if( token.c == '\\' && i + 1 < length )
+				token.c = glob[ ++i ];
+			else if( token.c == '?' )
+				token.type = AnyChar;
+			else if( token.c == '*' )
+			{
+				token.type = Star;
+				if( i + 1 < length && glob[ i + 1 ] == '*' )
+				{
+					i++;
+					token.type = AnyPath;
+					if( i + 1 < length && glob[ i + 1 ] == '/' &&
+						( i == 1 || glob[ i - 2 ] == '/' ) )
+					{
+						i++;
+						token.type = AnyFolders;
+					}
+				}
+			}
+			else if( token.c == '[' )
+			{
+				int j = i + 1;
+				const bool negated = j < length && ( glob[ j ] == '!' || glob[ j ] == '^' );
+				if( negated )
+					j++;
+
+				//A ']' right after the opening bracket is part of the class
+				const int first = j;
+				if( j < length && glob[ j ] == ']' )
+					j++;
+
+				while( j < length && glob[ j ] != ']' )
+					j++;
+
+				//No closing bracket: '[' is a plain character
+				if( j < length )
+				{
+					token.type = CharClass;
+					token.charClass = glob.mid( first, j - first );
+					token.negatedClass = negated;
+					i = j;
+				}
+			}
+
+			tokens.append( token );
+		}
+
+		return tokens;
+	}
+	//-------------------------------------------------------------------------
+	bool ExcludeRules::_matchGlob( const QVector<Token>& tokens, const QString& text )
+	{
+		//Simulate the automaton having a state before each token: active[ i ]
+		//means that the text read so far matches the first i tokens. States
+		//entered by consuming a token hold Entered, states only kept by a
+		//wildcard consuming one more character hold Looped
+		enum { Entered = 1, Looped = 2 };
+		const int n = tokens.count();
+		QVarLengthArray<char, 64> active( n + 1 );
+		QVarLengthArray<char, 64> next( n + 1 );
+		std::fill( active.data(), active.data() + n + 1, 0 );
+		active[ 0 ] = Entered;
+
+		//Stars may match nothing
+		for( int i = 0; i < n; i++ )
+		{
+			if( active[ i ] && tokens[ i ].type >= Star )
+				active[ i + 1 ] = Entered;
+		}
+
+		const int length = text.length();
+		for( int k = 0; k < length; k++ )
+		{
+			const QChar c = text[ k ];
+			bool alive = false;
+			std::fill( next.data(), next.data() + n + 1, 0 );
+
+			for( int i = 0; i < n; i++ )
+			{
+				if( !active[ i ] )
+					continue;
+
+				const Token& token = tokens[ i ];
+				switch( token.type )
+				{
+				case Char:
+					if( token.c == c )
+						next[ i + 1 ] |= Entered;
+					break;
+				case AnyChar:
+					if( c != '/' )
+						next[ i + 1 ] |= Entered;
+					break;
+				case CharClass:
+				{
+					bool inClass = false;
+					const QString& cls = token.charClass;
+					for( int j = 0; j < cls.length() && !inClass; j++ )
+					{
+						if( j + 2 < cls.length() && cls[ j + 1 ] == '-' )
+						{
+							inClass = c >= cls[ j ] && c <= cls[ j + 2 ];
+							j += 2;
+						}
+						else
+							inClass = c == cls[ j ];
+					}
+
+					if( c != '/' && inClass != token.negatedClass )
+						next[ i + 1 ] |= Entered;
+					break;
+				}
+				case Star:
+					if( c != '/' )
+						next[ i ] |= Looped;
+					break;
+				case AnyPath:
+					next[ i ] |= Looped;
+					break;
+				case AnyFolders:
+					next[ i ] |= Looped;
+					if( c == '/' )
+						next[ i + 1 ] |= Entered;
+					break;
+				}
+			}
+
+			//"**/" matches nothing only right where it starts: once it has
+			//consumed characters, it has to end with a slash
+			for( int i = 0; i < n; i++ )
+			{
+				const TokenType type = tokens[ i ].type;
+				const bool skip = type == AnyFolders ? ( next[ i ] & Entered ) != 0
+													 : type >= Star && next[ i ] != 0;
+				if( skip )
+					next[ i + 1 ] |= Entered;
+			}
+
+			for( int i = 0; i <= n; i++ )
+			{
+				active[ i ] = next[ i ];
+				alive |= next[ i ] != 0;
+			}
+
+			if( !alive )
+				return false;
+		}
+
+		return active[ n ] != 0;
+	}
+}
@@ -0,0 +1,173 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * excluderules.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef EXCLUDERULES_H
+#define EXCLUDERULES_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The ExcludeRules class matches paths against a list of
+	 * .gitignore-style patterns.
+	 *
+	 * Patterns are compiled once: literal names go to a hash table, "*.ext"
+	 * and "name*" patterns to suffix and prefix tables, and anything else to
+	 * a small glob automaton. As long as no pattern is negated ("!pattern"),
+	 * any match excludes; otherwise the last matching pattern decides, as
+	 * git does.
+	 *
+	 * Patterns without a slash match the name of an entry at any depth, the
+	 * others match its path relative to the base folder of the rules; a
+	 * trailing slash restricts a pattern to folders. Matching is thread safe.
+	 */
+	class ExcludeRules
+	{
+	public:
+		enum Match
+		{
+			NoMatch,
+			Excluded,
+			Included
+		};
+
+		ExcludeRules();
+
+		/**
+		 * @brief Compile \a patterns; empty ones and "#" comments are skipped.
+		 */
+		explicit ExcludeRules( const QStringList& patterns );
+
+		/**
+		 * @brief Compile the patterns of the .gitignore file \a fileName.
+		 * @return False if the file could not be read.
+		 */
+		bool loadGitignore( const QString& fileName );
+
+		/**
+		 * @brief Compile a single pattern and append it to the rules.
+		 */
+		void addPattern( const QString& pattern );
+
+		bool isEmpty() const { return _rules.isEmpty(); }
+
+		/**
+		 * @brief Return true if some pattern needs the relative path of the
+		 * entries, and not only their name.
+		 */
+		bool needsPath() const { return !_anchored.isEmpty(); }
+
+		/**
+		 * @brief Match an entry.
+		 * @param relativePath The entry path, relative to the base folder;
+		 * unused unless needsPath() is true.
+		 * @param name The entry name.
+		 * @param isFolder Whether the entry is a folder.
+		 */
+		Match match( const QString& relativePath, const QString& name, bool isFolder ) const;
+
+		/**
+		 * @brief Split a list of patterns separated by ';', as stored in
+		 * project files, dropping empty items.
+		 */
+		static QStringList splitPatterns( const QString& patterns );
+
+	private:
+		enum Kind
+		{
+			Literal,
+			Prefix,
+			Suffix,
+			Glob
+		};
+
+		enum TokenType
+		{
+			Char,
+			AnyChar,
+			CharClass,
+			Star,
+			//"**"
+			AnyPath,
+			//"**/", matching nothing or anything ending with a slash
+			AnyFolders
+		};
+
+		struct Token
+		{
+			TokenType type;
+			QChar c;
+			QString charClass;
+			bool negatedClass;
+		};
+
+		struct Rule
+		{
+			Kind kind;
+			QString text;
+			QVector<Token> tokens;
+			bool negated;
+			bool anchored;
+			bool folderOnly;
+		};
+
+		QVector<Rule> _rules;
+		QVector<int> _anchored;
+		bool _hasNegations;
+
+		//Fast tables of the unanchored, non negated rules: index 1 holds the
+		//folder only ones
+		QSet<QString> _literals[ 2 ];
+		QStringList _prefixes[ 2 ];
+		QStringList _suffixes[ 2 ];
+		QVector<int> _globs;
+
+		bool _matches( const Rule& rule, const QString& relativePath,
+					   const QString& name, bool isFolder ) const;
+		static QVector<Token> _compileGlob( const QString& glob );
+		static bool _matchGlob( const QVector<Token>& tokens, const QString& text );
+	};
+}
+
+#endif // EXCLUDERULES_H
@@ -0,0 +1,158 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * fileidset.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "fileidset.h"
+#include "helpers.h"
+
+namespace depgraphV
+{
+	//Device and inode are both all ones only in free slots
+	static const quint64 FREE_SLOT = ~Q_UINT64_C( 0 );
+	static const int INITIAL_SLOTS = 64;
+
+	FileIdSet::FileIdSet()
+		: _duplicates( 0 )
+	{
+		clear();
+	}
+	//-------------------------------------------------------------------------
+	bool FileIdSet::insert( quint64 device, quint64 inode )
+	{
+		const quint64 hash = _hash( device, inode );
+		Shard& s = _shards[ hash >> 60 ];
+		QMutexLocker locker( &s.mutex );
+
+		const int mask = s.slots.count() - 1;
+		for( int i = int( hash ) & mask; ; i = ( i + 1 ) & mask )
+		{
+			const FileId& slot = s.slots.at( i );
+			if( slot.device == device && slot.inode == inode )
+			{
+				_duplicates.ref();
+				return false;
+			}
+
+			if( slot.device == FREE_SLOT && slot.inode == FREE_SLOT )
+				break;
+		}
+
+		//Keep the table at most half full, so that probes stay short
+		if( ( s.count + 1 ) * 2 > s.slots.count() )
+		{
+			QVector<FileId> slots( s.slots.count() * 2 );
+			const FileId free = { FREE_SLOT, FREE_SLOT };
+			std::fill( slots.begin(), slots.end(), free );
+			foreach( const FileId& slot, s.slots )
+			{
+				if( slot.device != FREE_SLOT || slot.inode != FREE_SLOT )
+					_store( &slots, slot, _hash( slot.device, slot.inode ) );
+			}
+
+			s.slots.swap( slots );
+		}
+
+		const FileId id = { device, inode };
+		_store( &s.slots, id, hash );
+		s.count++;
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	int FileIdSet::count() const
+	{
+		int result = 0;
+		for( int i = 0; i < ShardCount; ++i )
+		{
+			QMutexLocker locker( &_shards[ i ].mutex );
+			result += _shards[ i ].count;
+		}
+
+		return result;
+	}
+	//-------------------------------------------------------------------------
+	int FileIdSet::duplicates() const
+	{
+		return Helpers::atomicLoad( _duplicates );
+	}
+	//-------------------------------------------------------------------------
+	void FileIdSet::clear()
+	{
+		const FileId free = { FREE_SLOT, FREE_SLOT };
+		for( int i = 0; i < ShardCount; ++i )
+		{
+			_shards[ i ].slots.fill( free, INITIAL_SLOTS );
+			_shards[ i ].count = 0;
+		}
+
+		Helpers::atomicStore( _duplicates, 0 );
+	}
+	//-------------------------------------------------------------------------
+	bool FileIdSet::read( const QString& path, FileId* id )
+	{
+		Q_ASSERT( id );
+#ifdef WIN32
+		Q_UNUSED( path );
+		return false;
+#else
+		struct stat st;
+		if( ::stat( QFile::encodeName( path ).constData(), &st ) != 0 )
+			return false;
+
+		id->device = st.st_dev;
+		id->inode = st.st_ino;
+		return true;
+#endif
+	}
+	//-------------------------------------------------------------------------
+	quint64 FileIdSet::_hash( quint64 device, quint64 inode )
+	{
+		//splitmix64 finalizer; the top bits select the shard
+		quint64 h = inode ^ ( device * Q_UINT64_C( 0x9e3779b97f4a7c15 ) );
+		h = ( h ^ ( h >> 30 ) ) * Q_UINT64_C( 0xbf58476d1ce4e5b9 );
+		h = ( h ^ ( h >> 27 ) ) * Q_UINT64_C( 0x94d049bb133111eb );
+		return h ^ ( h >> 31 );
+	}
+	//-------------------------------------------------------------------------
+	void FileIdSet::_store( QVector<FileId>* slots, const FileId& id, quint64 hash )
+	{
+		const int mask = slots->count() - 1;
+		int i = int( hash ) & mask;
+		while( slots->at( i ).device != FREE_SLOT || slots->at( i ).inode != FREE_SLOT )
+			i = ( i + 1 ) & mask;
+
+		( *slots )[ i ] = id;
+	}
+} // end of depgraphV namespace
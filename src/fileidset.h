@@ -0,0 +1,124 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * fileidset.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef FILEIDSET_H
+#define FILEIDSET_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The FileIdSet class remembers files and folders by their device
+	 * and inode numbers, so that one reachable through several paths
+	 * (overlapping roots, symbolic or hard links) is only handled once; it
+	 * also stops walks from looping through symbolic links.
+	 *
+	 * Ids are kept in open addressing tables of 16 bytes per slot, spread
+	 * over a fixed number of shards, each one guarded by its own mutex:
+	 * insert() can be called from any thread.
+	 */
+	class FileIdSet
+	{
+	public:
+		struct FileId
+		{
+			quint64 device;
+			quint64 inode;
+		};
+
+		FileIdSet();
+
+		/**
+		 * @brief Add the file identified by \a device and \a inode.
+		 * @return True if it was not in the set yet; false otherwise, in
+		 * which case it is counted as a duplicate.
+		 */
+		bool insert( quint64 device, quint64 inode );
+		bool insert( const FileId& id ) { return insert( id.device, id.inode ); }
+
+		/**
+		 * @brief Return the number of stored ids.
+		 */
+		int count() const;
+
+		/**
+		 * @brief Return how many times insert() found an id already stored.
+		 */
+		int duplicates() const;
+
+		/**
+		 * @brief Drop every id and reset the duplicates counter.
+		 * @remarks Not thread safe; call it only while nothing is inserted.
+		 */
+		void clear();
+
+		/**
+		 * @brief Read the id of the file at \a path, following symbolic links.
+		 * @return False if the file cannot be stat'ed, or on platforms
+		 * without inode numbers.
+		 */
+		static bool read( const QString& path, FileId* id );
+
+	private:
+		enum { ShardCount = 16 };
+
+		struct Shard
+		{
+			mutable QMutex mutex;
+			//Power of two sized; free slots hold FREE_SLOT in both fields
+			QVector<FileId> slots;
+			int count;
+		};
+
+		static quint64 _hash( quint64 device, quint64 inode );
+		static void _store( QVector<FileId>* slots, const FileId& id, quint64 hash );
+
+		Shard _shards[ ShardCount ];
+		QAtomicInt _duplicates;
+
+		Q_DISABLE_COPY( FileIdSet )
+	};
+}
+
+#endif // FILEIDSET_H
@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * filereader.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "filereader.h"
+
+namespace depgraphV
+{
+	QThreadStorage<QByteArray*> FileReader::_buffers;
+
+	FileReader::FileReader()
+		: _data( 0 ),
+		  _size( 0 ),
+		  _readPath( Automatic )
+	{
+	}
+	//-------------------------------------------------------------------------
+	FileReader::~FileReader()
+	{
+		close();
+	}
+	//-------------------------------------------------------------------------
+	bool FileReader::open( const QString& filePath, ReadPath path )
+	{
+		close();
+		_file.setFileName( filePath );
+		if( !_file.open( QIODevice::ReadOnly | QIODevice::Unbuffered ) )
+			return false;
+
+		qint64 fileSize = _file.size();
+		if( path == Automatic )
+			path = fileSize >= mapThreshold() ? Mapped : Buffered;
+
+		if( path == Mapped && fileSize > 0 )
+		{
+			uchar* mapped = _file.map( 0, fileSize );
+			if( mapped )
+			{
+				_data = reinterpret_cast<const char*>( mapped );
+				_size = fileSize;
+				_readPath = Mapped;
+				return true;
+			}
+
+			//Mapping is not supported for this file (a pipe, for instance);
+			//fall back to a plain read.
+		}
+
+		if( !_buffers.hasLocalData() )
+			_buffers.setLocalData( new QByteArray );
+
+		QByteArray* buffer = _buffers.localData();
+		if( buffer->size() < fileSize )
+			buffer->resize( fileSize );
+
+		qint64 read = fileSize > 0 ? _file.read( buffer->data(), fileSize ) : 0;
+		_file.close();
+
+		if( read < 0 )
+			return false;
+
+		_data = buffer->constData();
+		_size = read;
+		_readPath = Buffered;
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	void FileReader::close()
+	{
+		//Closing the file also unmaps it
+		if( _file.isOpen() )
+			_file.close();
+
+		_data = 0;
+		_size = 0;
+		_readPath = Automatic;
+	}
+} // end of depgraphV namespace
@@ -0,0 +1,115 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * filereader.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef FILEREADER_H
+#define FILEREADER_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The FileReader class gives read-only access to the bytes of a
+	 * file without any copy or codec conversion.
+	 *
+	 * Files bigger than mapThreshold() are memory mapped and scanned in place,
+	 * smaller ones are read with a single unbuffered read into a buffer which
+	 * is owned by the calling thread and reused by every FileReader running on
+	 * it. For this reason, data() stays valid only until the next open() on
+	 * the same thread.
+	 */
+	class FileReader
+	{
+	public:
+		/**
+		 * @brief The ReadPath enum describes how the file content has been
+		 * (or must be) loaded.
+		 */
+		enum ReadPath
+		{
+			Automatic,
+			Mapped,
+			Buffered
+		};
+
+		FileReader();
+		~FileReader();
+
+		/**
+		 * @brief Open the file at \a filePath and make its content available.
+		 * @param path The read path to use; Automatic selects it by file size.
+		 * @return True on success, false otherwise.
+		 */
+		bool open( const QString& filePath, ReadPath path = Automatic );
+
+		/**
+		 * @brief Release the file content.
+		 */
+		void close();
+
+		const char* data() const { return _data; }
+		qint64 size() const { return _size; }
+
+		/**
+		 * @brief Return the path used to load the currently open file.
+		 */
+		ReadPath readPath() const { return _readPath; }
+
+		/**
+		 * @brief Files of at least this size (in bytes) are memory mapped.
+		 */
+		static qint64 mapThreshold() { return 64 * 1024; }
+
+	private:
+		QFile _file;
+		const char* _data;
+		qint64 _size;
+		ReadPath _readPath;
+
+		static QThreadStorage<QByteArray*> _buffers;
+
+		Q_DISABLE_COPY( FileReader )
+	};
+}
+
+#endif // FILEREADER_H
@@ -0,0 +1,567 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * folderwalker.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "folderwalker.h"
+#include "helpers.h"
+
+namespace depgraphV
+{
+#ifdef Q_OS_LINUX
+	//Layout of the records returned by getdents64; glibc does not expose it
+	struct LinuxDirent64
+	{
+		quint64 d_ino;
+		qint64 d_off;
+		unsigned short d_reclen;
+		unsigned char d_type;
+		char d_name[ 1 ];
+	};
+#endif
+
+	//A queue of folders still to be listed, owned by a single worker
+	struct FolderQueue
+	{
+		QMutex mutex;
+		QList<FolderWalker::Folder> folders;
+	};
+
+	//Where workers with nothing left to list or steal wait for more folders
+	struct IdleWorkers
+	{
+		QMutex mutex;
+		QWaitCondition wakeUp;
+	};
+
+	class FolderWalkerWorker : public QRunnable
+	{
+	public:
+		FolderWalkerWorker( const FolderWalker* walker,
+							const QVector<FolderQueue*>& queues,
+							int index, QAtomicInt* pending,
+							IdleWorkers* idle,
+							const FolderWalker::FilesSink* sink,
+							const CancellationToken* cancellation )
+			: _walker( walker ),
+			  _queues( queues ),
+			  _index( index ),
+			  _pending( pending ),
+			  _idle( idle ),
+			  _sink( sink ),
+			  _cancellation( cancellation )
+		{
+			setAutoDelete( false );
+		}
+
+		void run()
+		{
+			QList<FolderWalker::Folder> subFolders;
+			QStringList files;
+			FolderWalker::Folder folder;
+
+			for( ;; )
+			{
+				//Every worker leaves on its own; queued folders are dropped
+				if( CancellationToken::isCancelled( _cancellation ) )
+				{
+					_wakeUpIdle();
+					return;
+				}
+
+				if( !_pop( &folder ) && !_steal( &folder ) && !_waitForFolder( &folder ) )
+					return;
+
+				subFolders.clear();
+				files.clear();
+				_walker->listFolder( folder, &subFolders, &files );
+				if( !files.isEmpty() )
+					( *_sink )( files );
+
+				//Subfolders are accounted before the current folder is
+				//released, so that pending never drops to zero too early
+				if( !subFolders.isEmpty() )
+				{
+					_pending->fetchAndAddOrdered( subFolders.count() );
+					FolderQueue* own = _queues[ _index ];
+					QMutexLocker locker( &own->mutex );
+					own->folders.append( subFolders );
+					locker.unlock();
+					_wakeUpIdle();
+				}
+
+				if( !_pending->deref() )
+					_wakeUpIdle();
+			}
+		}
+
+	private:
+		bool _pop( FolderWalker::Folder* folder )
+		{
+			FolderQueue* own = _queues[ _index ];
+			QMutexLocker locker( &own->mutex );
+			if( own->folders.isEmpty() )
+				return false;
+
+			*folder = own->folders.takeLast();
+			return true;
+		}
+
+		/**
+		 * Wait until a folder can be stolen, or until every folder has been
+		 * listed (or the walk is cancelled), in which case false is returned.
+		 * Conditions are checked under the lock taken to wake idle workers
+		 * up, so that no wake up can be missed.
+		 */
+		bool _waitForFolder( FolderWalker::Folder* folder )
+		{
+			QMutexLocker locker( &_idle->mutex );
+			for( ;; )
+			{
+				if( Helpers::atomicLoad( *_pending ) == 0 ||
+					CancellationToken::isCancelled( _cancellation ) )
+				{
+					return false;
+				}
+
+				if( _steal( folder ) )
+					return true;
+
+				_idle->wakeUp.wait( &_idle->mutex );
+			}
+		}
+
+		void _wakeUpIdle()
+		{
+			QMutexLocker locker( &_idle->mutex );
+			_idle->wakeUp.wakeAll();
+		}
+
+		bool _steal( FolderWalker::Folder* folder )
+		{
+			const int count = _queues.count();
+			for( int i = 1; i < count; i++ )
+			{
+				FolderQueue* victim = _queues[ ( _index + i ) % count ];
+				QMutexLocker locker( &victim->mutex );
+				if( !victim->folders.isEmpty() )
+				{
+					*folder = victim->folders.takeFirst();
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		const FolderWalker* _walker;
+		QVector<FolderQueue*> _queues;
+		int _index;
+		QAtomicInt* _pending;
+		IdleWorkers* _idle;
+		const FolderWalker::FilesSink* _sink;
+		const CancellationToken* _cancellation;
+	};
+	//-------------------------------------------------------------------------
+	FolderWalker::FolderWalker( const QStringList& nameFilters,
+								bool includeHiddenFolders )
+		: _nameFilters( nameFilters ),
+		  _includeHiddenFolders( includeHiddenFolders ),
+		  _honorGitignore( false ),
+		  _cancellation( 0 ),
+		  _seenFiles( 0 )
+	{
+		//"*.ext" patterns, by far the most common ones, are compared as
+		//plain suffixes; anything else goes through a wildcard QRegExp
+		foreach( QString filter, nameFilters )
+		{
+			QString suffix = filter.mid( 1 );
+			if( filter.startsWith( '*' ) && !suffix.isEmpty() &&
+				!suffix.contains( QRegExp( "[*?\\[\\]]" ) ) &&
+				suffix.toLatin1() == suffix.toUtf8() )
+			{
+				_suffixes.append( suffix.toLower().toLatin1() );
+			}
+			else
+				_patterns.append( QRegExp( filter, Qt::CaseInsensitive, QRegExp::Wildcard ) );
+		}
+	}
+	//-------------------------------------------------------------------------
+	bool FolderWalker::listFolder( const Folder& folder, QList<Folder>* subFolders,
+								   QStringList* files ) const
+	{
+		ScopePtr scope = folder.scope;
+		if( _honorGitignore )
+		{
+			ExcludeRules gitignore;
+			if( gitignore.loadGitignore( folder.path + "/.gitignore" ) &&
+				!gitignore.isEmpty() )
+			{
+				ExcludeScope* inner = new ExcludeScope();
+				inner->parent = scope;
+				inner->base = folder.path;
+				inner->rules = gitignore;
+				scope = ScopePtr( inner );
+			}
+		}
+
+#ifdef Q_OS_LINUX
+		return _listNative( folder.path, scope, subFolders, files );
+#else
+		return _listPortable( folder.path, scope, subFolders, files );
+#endif
+	}
+	//-------------------------------------------------------------------------
+	void FolderWalker::walkParallel( const QStringList& folders, const FilesSink& sink,
+									 int threadCount ) const
+	{
+		threadCount = qMax( 1, threadCount );
+
+		QVector<FolderQueue*> queues;
+		for( int i = 0; i < threadCount; i++ )
+			queues.append( new FolderQueue() );
+
+		for( int i = 0; i < folders.count(); i++ )
+			queues[ i % threadCount ]->folders.append( _rootFolder( folders[ i ] ) );
+
+		QAtomicInt pending( folders.count() );
+		IdleWorkers idle;
+		QList<FolderWalkerWorker*> workers;
+		QThreadPool pool;
+		pool.setMaxThreadCount( threadCount );
+
+		for( int i = 0; i < threadCount; i++ )
+		{
+			workers.append( new FolderWalkerWorker( this, queues, i, &pending,
+													&idle, &sink, _cancellation ) );
+			pool.start( workers.last() );
+		}
+
+		pool.waitForDone();
+		qDeleteAll( workers );
+		qDeleteAll( queues );
+	}
+	//-------------------------------------------------------------------------
+	FolderWalker::Folder FolderWalker::_rootFolder( const QString& path ) const
+	{
+		Folder root;
+		root.path = path;
+		if( !_excludeRules.isEmpty() )
+		{
+			ExcludeScope* scope = new ExcludeScope();
+			scope->base = path;
+			scope->rules = _excludeRules;
+			root.scope = ScopePtr( scope );
+		}
+
+		return root;
+	}
+	//-------------------------------------------------------------------------
+	bool FolderWalker::matches( const QString& fileName ) const
+	{
+		QByteArray name = QFile::encodeName( fileName );
+		return _matches( name.constData(), name.size() );
+	}
+	//-------------------------------------------------------------------------
+	bool FolderWalker::accepts( const QString& root, const QString& path ) const
+	{
+		int start = root.length();
+		if( !root.endsWith( '/' ) )
+			start++;
+
+		if( path.length() <= start || !path.startsWith( root ) || path[ start - 1 ] != '/' )
+			return false;
+
+		//Each folder on the way is checked the way it is when listed
+		const int relativeStart = start;
+		for( ;; )
+		{
+			const int slash = path.indexOf( '/', start );
+			const bool isFolder = slash >= 0;
+			const int end = isFolder ? slash : path.length();
+			const QString name = path.mid( start, end - start );
+
+			if( name.startsWith( '.' ) && ( !isFolder || !_includeHiddenFolders ) )
+				return false;
+
+			if( !isFolder && !matches( name ) )
+				return false;
+
+			if( !_excludeRules.isEmpty() )
+			{
+				QString relativePath;
+				if( _excludeRules.needsPath() )
+					relativePath = path.mid( relativeStart, end - relativeStart );
+
+				if( _excludeRules.match( relativePath, name, isFolder ) == ExcludeRules::Excluded )
+					return false;
+			}
+
+			if( !isFolder )
+				return true;
+
+			start = slash + 1;
+		}
+	}
+	//-------------------------------------------------------------------------
+	bool FolderWalker::_listNative( const QString& path, const ScopePtr& scope,
+									QList<Folder>* subFolders, QStringList* files ) const
+	{
+#ifdef Q_OS_LINUX
+		int fd = ::open( QFile::encodeName( path ).constData(),
+						 O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+		if( fd < 0 )
+			return false;
+
+		//A folder reached again, through a link or an overlapping root, has
+		//already been listed
+		struct stat folderStat;
+		folderStat.st_dev = 0;
+		if( _seenFiles && ::fstat( fd, &folderStat ) == 0 &&
+			!_seenFiles->insert( folderStat.st_dev, folderStat.st_ino ) )
+		{
+			::close( fd );
+			return true;
+		}
+
+		QString prefix = path.endsWith( '/' ) ? path : path + '/';
+		//Records hold 64-bit fields and are padded to 8 bytes by the kernel,
+		//so the buffer must be aligned accordingly
+		quint64 buffer[ 32 * 1024 / sizeof( quint64 ) ];
+
+		for( ;; )
+		{
+			long count = ::syscall( SYS_getdents64, fd, buffer, sizeof( buffer ) );
+			if( count <= 0 )
+				break;
+
+			for( long offset = 0; offset < count; )
+			{
+				const LinuxDirent64* entry =
+						reinterpret_cast<const LinuxDirent64*>(
+							reinterpret_cast<const char*>( buffer ) + offset );
+				offset += entry->d_reclen;
+
+				const char* name = entry->d_name;
+				if( name[ 0 ] == '.' &&
+					( name[ 1 ] == '\0' || ( name[ 1 ] == '.' && name[ 2 ] == '\0' ) ) )
+				{
+					continue;
+				}
+
+				unsigned char type = entry->d_type;
+				bool identified = false;
+				quint64 device = 0;
+				quint64 inode = 0;
+				if( type == DT_UNKNOWN || type == DT_LNK )
+				{
+					//Symbolic links are followed, like QDir does
+					struct stat st;
+					int flags = type == DT_UNKNOWN ? AT_SYMLINK_NOFOLLOW : 0;
+					if( ::fstatat( fd, name, &st, flags ) != 0 )
+						continue;
+
+					if( S_ISLNK( st.st_mode ) &&
+						::fstatat( fd, name, &st, 0 ) != 0 )
+					{
+						continue;
+					}
+
+					identified = true;
+					device = st.st_dev;
+					inode = st.st_ino;
+					if( S_ISDIR( st.st_mode ) )
+						type = DT_DIR;
+					else if( S_ISREG( st.st_mode ) )
+						type = DT_REG;
+					else
+						type = DT_UNKNOWN;
+				}
+
+				const bool hidden = name[ 0 ] == '.';
+				if( type == DT_DIR )
+				{
+					if( !subFolders || ( hidden && !_includeHiddenFolders ) )
+						continue;
+
+					Folder child;
+					QString childName = QFile::decodeName( name );
+					child.path = prefix + childName;
+					child.scope = scope;
+					if( !_isExcluded( scope.data(), child.path, childName, true ) )
+						subFolders->append( child );
+				}
+				else if( type == DT_REG && files && !hidden &&
+						 _matches( name, int( qstrlen( name ) ) ) )
+				{
+					QString fileName = QFile::decodeName( name );
+					QString filePath = prefix + fileName;
+					if( _isExcluded( scope.data(), filePath, fileName, false ) )
+						continue;
+
+					if( _seenFiles )
+					{
+						if( !identified )
+						{
+							struct stat st;
+							if( ::fstatat( fd, name, &st, 0 ) != 0 )
+								continue;
+
+							device = st.st_dev;
+							inode = st.st_ino;
+						}
+
+						if( !_seenFiles->insert( device, inode ) )
+							continue;
+					}
+
+					files->append( filePath );
+				}
+			}
+		}
+
+		::close( fd );
+		return true;
+#else
+		return _listPortable( path, scope, subFolders, files );
+#endif
+	}
+	//-------------------------------------------------------------------------
+	bool FolderWalker::_listPortable( const QString& path, const ScopePtr& scope,
+									  QList<Folder>* subFolders, QStringList* files ) const
+	{
+		QDir d( path );
+		if( !d.exists() )
+			return false;
+
+		FileIdSet::FileId id;
+		if( _seenFiles && FileIdSet::read( path, &id ) && !_seenFiles->insert( id ) )
+			return true;
+
+		if( subFolders )
+		{
+			QFlags<QDir::Filter> flags = QDir::NoDotAndDotDot | QDir::Dirs;
+			if( _includeHiddenFolders )
+				flags |= QDir::Hidden;
+
+			foreach( QFileInfo childFolderInfo, d.entryInfoList( flags ) )
+			{
+				Folder child;
+				child.path = childFolderInfo.filePath();
+				child.scope = scope;
+				if( !_isExcluded( scope.data(), child.path, childFolderInfo.fileName(), true ) )
+					subFolders->append( child );
+			}
+		}
+
+		if( files )
+		{
+			d.setNameFilters( _nameFilters );
+			foreach( QFileInfo fileEntry, d.entryInfoList( QDir::NoDotAndDotDot | QDir::Files ) )
+			{
+				if( _isExcluded( scope.data(), fileEntry.filePath(), fileEntry.fileName(), false ) )
+					continue;
+
+				//QFileInfo does not expose inodes, it takes one more stat
+				if( _seenFiles && FileIdSet::read( fileEntry.filePath(), &id ) &&
+					!_seenFiles->insert( id ) )
+				{
+					continue;
+				}
+
+				files->append( fileEntry.filePath() );
+			}
+		}
+
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	bool FolderWalker::_isExcluded( const ExcludeScope* scope, const QString& path,
+									const QString& name, bool isFolder )
+	{
+		for( ; scope; scope = scope->parent.data() )
+		{
+			QString relativePath;
+			if( scope->rules.needsPath() )
+			{
+				const int baseLength = scope->base.length();
+				relativePath = path.mid( scope->base.endsWith( '/' ) ? baseLength
+																	 : baseLength + 1 );
+			}
+
+			ExcludeRules::Match match = scope->rules.match( relativePath, name, isFolder );
+			if( match != ExcludeRules::NoMatch )
+				return match == ExcludeRules::Excluded;
+		}
+
+		return false;
+	}
+	//-------------------------------------------------------------------------
+	bool FolderWalker::_matches( const char* name, int length ) const
+	{
+		foreach( const QByteArray& suffix, _suffixes )
+		{
+			const int suffixLength = suffix.size();
+			if( length < suffixLength )
+				continue;
+
+			const char* tail = name + length - suffixLength;
+			int i = 0;
+			while( i < suffixLength &&
+				   ( tail[ i ] >= 'A' && tail[ i ] <= 'Z' ? tail[ i ] + 32 : tail[ i ] )
+				   == suffix[ i ] )
+			{
+				i++;
+			}
+
+			if( i == suffixLength )
+				return true;
+		}
+
+		if( _patterns.isEmpty() )
+			return false;
+
+		QString fileName = QFile::decodeName( name );
+		foreach( QRegExp pattern, _patterns )
+		{
+			//Every thread matches against its own copy, QRegExp keeps the
+			//state of the last match
+			if( pattern.exactMatch( fileName ) )
+				return true;
+		}
+
+		return false;
+	}
+}
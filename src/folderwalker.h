@@ -0,0 +1,202 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * folderwalker.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef FOLDERWALKER_H
+#define FOLDERWALKER_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef EXCLUDERULES_H
+#	include "excluderules.h"
+#endif
+
+#ifndef CANCELLATIONTOKEN_H
+#	include "cancellationtoken.h"
+#endif
+
+#ifndef FILEIDSET_H
+#	include "fileidset.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The FolderWalker class lists the files found below a folder
+	 * which match a set of name filters.
+	 *
+	 * On Linux, folder entries are read with getdents64 and their type is
+	 * taken from d_type, so that no entry needs a stat call unless the file
+	 * system does not report it (or the entry is a symbolic link). Other
+	 * platforms fall back to QDir.
+	 *
+	 * Exclude rules, and optionally the .gitignore files found on the way,
+	 * are checked before a folder is queued, so excluded subtrees are never
+	 * listed.
+	 *
+	 * When given a FileIdSet, folders and files already in it are skipped:
+	 * overlapping roots and symbolic links then yield each file once, and
+	 * links pointing back to a parent folder cannot loop. Each file kept is
+	 * stat'ed then: the inode in its folder entry does not always match the
+	 * one stat reports (on overlayfs, or for bind mounts), which the parse
+	 * stage records in the same set.
+	 *
+	 * A FolderWalker holds no mutable state once built: the same instance
+	 * can be used by several threads at once, which is what walkParallel()
+	 * does.
+	 */
+	class FolderWalker
+	{
+	public:
+		/**
+		 * @brief Receives the matching files of each listed folder; it is
+		 * called concurrently by the walking threads.
+		 */
+		typedef std::function<void( const QStringList& )> FilesSink;
+
+		/**
+		 * @brief Exclude rules applying to a folder and its subfolders;
+		 * rules of inner scopes take precedence over the outer ones.
+		 */
+		struct ExcludeScope
+		{
+			QSharedPointer<const ExcludeScope> parent;
+			//Folder the rules are relative to
+			QString base;
+			ExcludeRules rules;
+		};
+
+		/**
+		 * @brief A folder still to be listed, along with its exclude rules.
+		 */
+		struct Folder
+		{
+			QString path;
+			QSharedPointer<const ExcludeScope> scope;
+		};
+
+		/**
+		 * @brief FolderWalker constructor.
+		 * @param nameFilters Wildcard patterns files must match ("*.h",
+		 * for instance); matching is case insensitive, like QDir does.
+		 * @param includeHiddenFolders Whether hidden folders are visited.
+		 */
+		FolderWalker( const QStringList& nameFilters, bool includeHiddenFolders );
+
+		/**
+		 * @brief Set the rules excluding files and folders, relative to each
+		 * walked root folder.
+		 */
+		void setExcludeRules( const ExcludeRules& rules ) { _excludeRules = rules; }
+
+		/**
+		 * @brief Set whether the .gitignore files found in the walked folders
+		 * exclude files and folders too.
+		 */
+		void setHonorGitignore( bool honor ) { _honorGitignore = honor; }
+
+		/**
+		 * @brief Set the token which stops walks as soon as it is cancelled,
+		 * returning the files found so far; it must outlive the walks.
+		 */
+		void setCancellationToken( const CancellationToken* token ) { _cancellation = token; }
+
+		/**
+		 * @brief Set the set recording every folder listed and file found,
+		 * which are skipped if already recorded; it must outlive the walks
+		 * and can be shared with other walkers or stages.
+		 */
+		void setSeenFiles( FileIdSet* seenFiles ) { _seenFiles = seenFiles; }
+
+		/**
+		 * @brief Walk \a folders and their subfolders using \a threadCount
+		 * threads, handing the files of every folder to \a sink as soon as
+		 * it is listed, in no particular order.
+		 *
+		 * Every folder is a separate task: each thread pops its own tasks in
+		 * depth-first order and, once it runs out of them, steals the
+		 * shallowest folders still queued by the others.
+		 */
+		void walkParallel( const QStringList& folders, const FilesSink& sink,
+						   int threadCount = QThread::idealThreadCount() ) const;
+
+		/**
+		 * @brief Return true if \a fileName matches one of the name filters.
+		 */
+		bool matches( const QString& fileName ) const;
+
+		/**
+		 * @brief Return true if walking \a root would list the file at
+		 * \a path: no folder between them is hidden (unless hidden folders
+		 * are visited) or excluded, and the file itself is neither hidden nor
+		 * excluded, and matches the name filters. The .gitignore files are
+		 * not read.
+		 */
+		bool accepts( const QString& root, const QString& path ) const;
+
+		/**
+		 * @brief List the direct children of \a folder, skipping the excluded
+		 * ones; subfolders inherit the rules of \a folder.
+		 */
+		bool listFolder( const Folder& folder, QList<Folder>* subFolders,
+						 QStringList* files ) const;
+
+	private:
+		typedef QSharedPointer<const ExcludeScope> ScopePtr;
+
+		Folder _rootFolder( const QString& path ) const;
+		bool _listNative( const QString& path, const ScopePtr& scope,
+						  QList<Folder>* subFolders, QStringList* files ) const;
+		bool _listPortable( const QString& path, const ScopePtr& scope,
+							QList<Folder>* subFolders, QStringList* files ) const;
+		bool _matches( const char* name, int length ) const;
+		static bool _isExcluded( const ExcludeScope* scope, const QString& path,
+								 const QString& name, bool isFolder );
+
+		QStringList _nameFilters;
+		QList<QByteArray> _suffixes;
+		QList<QRegExp> _patterns;
+		bool _includeHiddenFolders;
+		ExcludeRules _excludeRules;
+		bool _honorGitignore;
+		const CancellationToken* _cancellation;
+		FileIdSet* _seenFiles;
+	};
+}
+
+#endif // FOLDERWALKER_H
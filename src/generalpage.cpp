@@ -37,6 +37,7 @@
  */
 #include "generalpage.h"
 #include "ui_generalpage.h"
+#include "batchreader.h"
 
 namespace depgraphV
 {
@@ -46,6 +47,10 @@ namespace depgraphV
 	{
 		_ui->setupUi( this );
 
+		//Not available on this kernel or platform
+		if( !BatchReader::isSupported() )
+			_ui->ioUringReads->setEnabled( false );
+
 		connect( Singleton<AppConfig>::instancePtr(), SIGNAL( configRestored() ),
 				 this, SLOT( _onConfigRestored() )
 		);
@@ -77,6 +82,9 @@ namespace depgraphV
 		_ui->warnOnGraphClearing->setChecked( c->warnOnGraphClearing() );
 		_ui->fileSystemRedrawRadio->setChecked( c->redrawGraphOnFileSystemChanges() );
 		_ui->autoApplyChanges->setChecked( c->autoApplySettingChanges() );
+		_ui->hashFileContents->setChecked( c->hashFileContents() );
+		_ui->ioUringReads->setChecked( c->ioUringReads() );
+		_ui->ioUringQueueDepth->setValue( c->ioUringQueueDepth() );
 
 		connect( _ui->warnOnGraphRemoval, SIGNAL( toggled( bool ) ),
 				 c, SLOT( setWarnOnGraphRemoval( bool ) )
@@ -90,6 +98,15 @@ namespace depgraphV
 		connect( _ui->autoApplyChanges, SIGNAL( toggled( bool ) ),
 				 c, SLOT( setAutoApplySettingChanges( bool ) )
 		);
+		connect( _ui->hashFileContents, SIGNAL( toggled( bool ) ),
+				 c, SLOT( setHashFileContents( bool ) )
+		);
+		connect( _ui->ioUringReads, SIGNAL( toggled( bool ) ),
+				 c, SLOT( setIoUringReads( bool ) )
+		);
+		connect( _ui->ioUringQueueDepth, SIGNAL( valueChanged( int ) ),
+				 c, SLOT( setIoUringQueueDepth( int ) )
+		);
 	}
 
 } // end of depgraphV namespace
@@ -0,0 +1,283 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * gitindex.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "gitindex.h"
+#include "filereader.h"
+
+namespace depgraphV
+{
+	#define GIT_INDEX_SIGNATURE			"DIRC"
+	#define GIT_INDEX_EXTENDED_FLAG		0x4000
+	#define GIT_INDEX_SKIP_WORKTREE		0x4000
+	#define GIT_INDEX_REGULAR_FILE		010
+
+	static inline quint32 _read32( const char* p )
+	{
+		return qFromBigEndian<quint32>( reinterpret_cast<const uchar*>( p ) );
+	}
+
+	static inline quint16 _read16( const char* p )
+	{
+		return qFromBigEndian<quint16>( reinterpret_cast<const uchar*>( p ) );
+	}
+	//-------------------------------------------------------------------------
+	GitIndex::GitIndex()
+		: _valid( false ),
+		  _version( 0 )
+	{
+	}
+	//-------------------------------------------------------------------------
+	bool GitIndex::load( const QString& folder )
+	{
+		*this = GitIndex();
+
+		QString gitDir;
+		_workTree = findWorkTree( folder, &gitDir );
+		if( _workTree.isEmpty() )
+		{
+			_errorString = QCoreApplication::translate(
+							   "GitIndex", "\"%1\" is not part of a git work tree."
+			).arg( folder );
+			return false;
+		}
+
+		//Repositories using SHA-256 object names have longer entries
+		int hashSize = 20;
+		QFile config( gitDir + "/config" );
+		if( config.open( QIODevice::ReadOnly ) )
+		{
+			QByteArray text = config.readAll().toLower();
+			text.replace( ' ', "" ).replace( '\t', "" );
+			if( text.contains( "objectformat=sha256" ) )
+				hashSize = 32;
+		}
+
+		QString indexFile = gitDir + "/index";
+		FileReader reader;
+		if( !reader.open( indexFile ) )
+		{
+			_errorString = QCoreApplication::translate(
+							   "GitIndex", "Unable to read \"%1\"."
+			).arg( indexFile );
+			return false;
+		}
+
+		_valid = _parse( reader.data(), reader.size(), hashSize );
+		if( !_valid )
+		{
+			_errorString = QCoreApplication::translate(
+							   "GitIndex", "\"%1\" is not a valid git index (%2)."
+			).arg( indexFile ).arg( _errorString );
+			_files.clear();
+		}
+
+		return _valid;
+	}
+	//-------------------------------------------------------------------------
+	QString GitIndex::findWorkTree( const QString& folder, QString* gitDir )
+	{
+		QString path = QDir::cleanPath( QFileInfo( folder ).absoluteFilePath() );
+
+		for( ;; )
+		{
+			QString dotGit = path.endsWith( '/' ) ? path + ".git" : path + "/.git";
+			QFileInfo info( dotGit );
+
+			if( info.isDir() )
+			{
+				if( gitDir )
+					*gitDir = dotGit;
+
+				return path;
+			}
+
+			//Worktrees and submodules have a ".git" file pointing to the
+			//actual git directory
+			if( info.isFile() )
+			{
+				QFile f( dotGit );
+				if( f.open( QIODevice::ReadOnly ) )
+				{
+					QString line = QString::fromUtf8( f.readLine() ).trimmed();
+					if( line.startsWith( "gitdir:" ) )
+					{
+						if( gitDir )
+						{
+							*gitDir = QDir::cleanPath(
+										  QDir( path ).absoluteFilePath( line.mid( 7 ).trimmed() )
+							);
+						}
+
+						return path;
+					}
+				}
+			}
+
+			int slash = path.lastIndexOf( '/' );
+			if( slash < 0 || path.length() == slash + 1 )
+				break;
+
+			path = path.left( qMax( slash, path.indexOf( '/' ) + 1 ) );
+		}
+
+		return QString();
+	}
+	//-------------------------------------------------------------------------
+	bool GitIndex::_parse( const char* data, qint64 size, int hashSize )
+	{
+		//Header and trailing checksum
+		if( size < 12 + hashSize || qstrncmp( data, GIT_INDEX_SIGNATURE, 4 ) != 0 )
+		{
+			_errorString = QCoreApplication::translate( "GitIndex", "bad signature" );
+			return false;
+		}
+
+		_version = int( _read32( data + 4 ) );
+		if( _version < 2 || _version > 4 )
+		{
+			_errorString = QCoreApplication::translate(
+							   "GitIndex", "unsupported version %1"
+			).arg( _version );
+			return false;
+		}
+
+		const quint32 count = _read32( data + 8 );
+		const char* p = data + 12;
+		const char* end = data + size - hashSize;
+		const int statSize = 40;
+		const int fixedSize = statSize + hashSize + 2;
+
+		const QString prefix = _workTree.endsWith( '/' ) ? _workTree : _workTree + '/';
+		const QString truncated = QCoreApplication::translate( "GitIndex", "truncated entry" );
+		QByteArray previousName;
+		_files.reserve( int( count ) );
+
+		for( quint32 i = 0; i < count; i++ )
+		{
+			const char* entryStart = p;
+			if( end - p < fixedSize )
+			{
+				_errorString = truncated;
+				return false;
+			}
+
+			const quint32 mode = _read32( p + 24 );
+			const quint16 flags = _read16( p + statSize + hashSize );
+			p += fixedSize;
+
+			quint16 extendedFlags = 0;
+			if( flags & GIT_INDEX_EXTENDED_FLAG )
+			{
+				if( _version < 3 || end - p < 2 )
+				{
+					_errorString = truncated;
+					return false;
+				}
+
+				extendedFlags = _read16( p );
+				p += 2;
+			}
+
+			QString name;
+			if( _version == 4 )
+			{
+				//Names are prefix compressed: a varint tells how many bytes
+				//to drop from the end of the previous name, then the suffix
+				//follows, NUL terminated
+				if( p >= end )
+				{
+					_errorString = truncated;
+					return false;
+				}
+
+				quint64 strip = uchar( *p ) & 0x7f;
+				while( uchar( *p++ ) & 0x80 )
+				{
+					if( p >= end )
+					{
+						_errorString = truncated;
+						return false;
+					}
+
+					strip = ( ( strip + 1 ) << 7 ) | ( uchar( *p ) & 0x7f );
+				}
+
+				const char* nul = static_cast<const char*>( memchr( p, 0, end - p ) );
+				if( !nul || strip > quint64( previousName.size() ) )
+				{
+					_errorString = truncated;
+					return false;
+				}
+
+				previousName.truncate( previousName.size() - int( strip ) );
+				previousName.append( p, int( nul - p ) );
+				name = QString::fromUtf8( previousName.constData(), previousName.size() );
+				p = nul + 1;
+			}
+			else
+			{
+				//Entries are padded with 1 to 8 NULs to a multiple of 8 bytes
+				const char* nul = static_cast<const char*>( memchr( p, 0, end - p ) );
+				if( !nul )
+				{
+					_errorString = truncated;
+					return false;
+				}
+
+				name = QString::fromUtf8( p, int( nul - p ) );
+				p = entryStart + ( ( nul - entryStart + 8 ) & ~7 );
+				if( p > end )
+				{
+					_errorString = truncated;
+					return false;
+				}
+			}
+
+			//Merge conflicts, sparse checkouts, symbolic links and submodules
+			const int stage = ( flags >> 12 ) & 3;
+			if( stage != 0 || ( extendedFlags & GIT_INDEX_SKIP_WORKTREE ) ||
+				( mode >> 12 ) != GIT_INDEX_REGULAR_FILE )
+			{
+				continue;
+			}
+
+			_files.append( prefix + name );
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,106 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * gitindex.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef GITINDEX_H
+#define GITINDEX_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The GitIndex class reads the index file of a git work tree
+	 * (.git/index, versions 2 to 4), which lists every tracked file.
+	 *
+	 * The file is parsed in place, without running git; only stage 0
+	 * entries of regular files which are present in the work tree (i.e.
+	 * not skipped by a sparse checkout) are collected.
+	 */
+	class GitIndex
+	{
+	public:
+		GitIndex();
+
+		/**
+		 * @brief Find the work tree containing \a folder and read its index.
+		 * @return False if \a folder is not part of a git work tree, or on
+		 * I/O or format errors; see errorString().
+		 */
+		bool load( const QString& folder );
+
+		bool isValid() const { return _valid; }
+		const QString& errorString() const { return _errorString; }
+
+		/**
+		 * @brief Return the root of the work tree the index belongs to.
+		 */
+		const QString& workTree() const { return _workTree; }
+
+		int version() const { return _version; }
+
+		/**
+		 * @brief Return the absolute paths of the tracked files.
+		 */
+		const QStringList& files() const { return _files; }
+
+		/**
+		 * @brief Look for the work tree containing \a folder, going up to the
+		 * file system root.
+		 * @param gitDir If not null, receives the git directory of the work
+		 * tree, following ".git" files (worktrees and submodules).
+		 * @return The work tree root, or an empty string if none is found.
+		 */
+		static QString findWorkTree( const QString& folder, QString* gitDir = 0 );
+
+	private:
+		bool _parse( const char* data, qint64 size, int hashSize );
+
+		bool _valid;
+		QString _errorString;
+		QString _workTree;
+		int _version;
+		QStringList _files;
+	};
+}
+
+#endif // GITINDEX_H
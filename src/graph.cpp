@@ -38,34 +38,83 @@
 #include "graph.h"
 #include "helpers.h"
 #include "project.h"
+#include "includescanner.h"
+#include "filereader.h"
+
+#include <algorithm>
 
 #define G_STR( str ) str.toUtf8().data()
 
 #ifdef GraphViz_USE_CGRAPH
-#	define NEW_GRAPH()	_graph = agopen( G_STR( QString( "" ) ), Agdirected, 0 )
+#	define NEW_GRAPH()	agopen( G_STR( QString( "" ) ), Agdirected, 0 )
 #else
-#	define NEW_GRAPH()	_graph = agopen( G_STR( QString( "" ) ), AGDIGRAPH )
+#	define NEW_GRAPH()	agopen( G_STR( QString( "" ) ), AGDIGRAPH )
 #endif
 
 namespace depgraphV
 {
 	unsigned short Graph::_instances = 0;
 	GVC_t* Graph::_context = 0;
+	QMutex Graph::_graphvizMutex;
 	QMap<QString, QStringList*> Graph::_availablePlugins;
-	QMap<QString, QStringList*> Graph::_parsedFiles;
+	ParseCache Graph::_parseCache;
+
+	namespace
+	{
+		/**
+		 * @brief Orders vertices by name, whatever order they were added in.
+		 */
+		struct ByName
+		{
+			explicit ByName( const DependencyGraph& g ) : graph( &g ) {}
+
+			bool operator()( DependencyGraph::VertexId a, DependencyGraph::VertexId b ) const
+			{
+				return qstrcmp( graph->utf8Name( a ), graph->utf8Name( b ) ) < 0;
+			}
+
+			const DependencyGraph* graph;
+		};
+	}
+
+	/**
+	 * @brief A GraphViz graph handed over to the layout thread by
+	 * applyLayout(), with the context it is laid out in. Once abandoned, the
+	 * layout thread frees both as soon as gvLayout returns; once finished,
+	 * whoever takes them frees them.
+	 */
+	struct Graph::LayoutJob
+	{
+		explicit LayoutJob( Agraph_t* g )
+			: graph( g ), context( 0 ), abandoned( false ), finished( false )
+		{}
+
+		QMutex mutex;
+		Agraph_t* graph;
+		GVC_t* context;
+		bool abandoned;
+		bool finished;
+	};
 
 	Graph::Graph( QWidget* parent )
 		: QGraphicsView( parent ),
 		  _svgItem( 0 ),
+		  _layoutContext( 0 ),
+		  _transitiveReduction( false ),
+		  _scanMode( IncludeScanner::FullFile ),
 		  _drawn( false ),
 		  _foldersModel( new FoldersModel( this ) )
 	{
 		_instances++;
+		_resetChanges();
 
-		if( !_context )
-			_context = gvContext();
+		{
+			QMutexLocker locker( &_graphvizMutex );
+			if( !_context )
+				_context = gvContext();
 
-		NEW_GRAPH();
+			_graph = NEW_GRAPH();
+		}
 
 		setScene( new QGraphicsScene( this ) );
 		_setDefaultAttributes();
@@ -76,23 +125,27 @@ namespace depgraphV
 		connect( this, SIGNAL( layoutApplied( bool, const QString& ) ),
 				 this, SLOT( _onLayoutApplied( bool, const QString& ) )
 		);
+		connect( this, SIGNAL( layoutCancelled() ),
+				 this, SLOT( _onLayoutCancelled() )
+		);
 	}
 	//-------------------------------------------------------------------------
 	Graph::~Graph()
 	{
 		_instances--;
+		_abandonLayoutJob();
 		clearLayout();
 
-		_vertices.clear();
+		_dependencies.clear();
 		_graphAttributes.clear();
 		_verticesAttributes.clear();
 		_edgesAttributes.clear();
 
+		//Abandoned layouts, which may still be running, have contexts of
+		//their own
+		QMutexLocker locker( &_graphvizMutex );
 		if( !_instances )
 		{
-			foreach( QStringList* l, _parsedFiles )
-				delete l;
-
 			gvFreeContext( _context );
 			_context = 0;
 		}
@@ -147,6 +200,11 @@ namespace depgraphV
 		_layoutAlgorithm = value;
 	}
 	//-------------------------------------------------------------------------
+	void Graph::setTransitiveReduction( bool value )
+	{
+		_transitiveReduction = value;
+	}
+	//-------------------------------------------------------------------------
 	QString Graph::graphAttribute( const QString& name ) const
 	{
 		if( _graphAttributes.contains( name ) )
@@ -177,6 +235,7 @@ namespace depgraphV
 		Q_ASSERT( !value.isEmpty() && "Attribute value is empty!" );
 		_graphAttributes[ name ] = value;
 
+		QMutexLocker locker( &_graphvizMutex );
 #ifdef GraphViz_USE_CGRAPH
 		agattr( _graph, AGRAPH, G_STR( name ), G_STR( value ) );
 #else
@@ -190,6 +249,7 @@ namespace depgraphV
 		Q_ASSERT( !value.isEmpty() && "Attribute value is empty!" );
 		_verticesAttributes[ name ] = value;
 
+		QMutexLocker locker( &_graphvizMutex );
 #ifdef GraphViz_USE_CGRAPH
 		agattr( _graph, AGNODE, G_STR( name ), G_STR( value ) );
 #else
@@ -203,6 +263,7 @@ namespace depgraphV
 		Q_ASSERT( !value.isEmpty() && "Attribute value is empty!" );
 		_edgesAttributes[ name ] = value;
 
+		QMutexLocker locker( &_graphvizMutex );
 #ifdef GraphViz_USE_CGRAPH
 		agattr( _graph, AGEDGE, G_STR( name ), G_STR( value ) );
 #else
@@ -210,116 +271,385 @@ namespace depgraphV
 #endif
 	}
 	//-------------------------------------------------------------------------
-	Agnode_t* Graph::createVertex( const QString& label )
+	void Graph::setVertexAttribute( DependencyGraph::VertexId v,
+									const QString& name, const QString& value )
 	{
-		Q_ASSERT( !label.isEmpty() && "Label cannot be empty!" );
-#ifdef GraphViz_USE_CGRAPH
-		Agnode_t* v = agnode( _graph, G_STR( label ), TRUE );
-#else
-		Agnode_t* v = agnode( _graph, G_STR( label ) );
-#endif
-		if( !v )
-		{
-			qWarning() << qPrintable( tr( "Invalid vertex:" ) ) << label;
-			return 0;
-		}
+		Q_ASSERT( !name.isEmpty() && "Attribute name is empty!" );
+		_dependencies.setVertexAttribute( v, name, value );
+	}
+	//-------------------------------------------------------------------------
+	void Graph::setEdgeAttribute( DependencyGraph::EdgeId e,
+								  const QString& name, const QString& value )
+	{
+		Q_ASSERT( !name.isEmpty() && "Attribute name is empty!" );
+		_dependencies.compact();
+		_dependencies.setEdgeAttribute( e, name, value );
+	}
+	//-------------------------------------------------------------------------
+	DependencyGraph::VertexId Graph::createVertex( const QString& name,
+												   const QString& label )
+	{
+		Q_ASSERT( !name.isEmpty() && "Name cannot be empty!" );
+		return _dependencies.addVertex( name, label );
+	}
+	//-------------------------------------------------------------------------
+	DependencyGraph::VertexId Graph::vertex( const QString& name ) const
+	{
+		Q_ASSERT( !name.isEmpty() && "Name cannot be empty!" );
+		return _dependencies.vertex( name );
+	}
+	//-------------------------------------------------------------------------
+	Graph::ParsedFile Graph::parseFile( const QString& absFilePath,
+										IncludeScanner::Mode mode,
+										IncludeResolver* resolver,
+										FileIdSet* seenFiles )
+	{
+		ParsedFile result = _emptyParsedFile( absFilePath );
+		if( _readIncludes( absFilePath, mode, seenFiles, &result ) )
+			_resolveIncludes( resolver, &result );
 
-		_vertices.insert( label, v );
-		emit vertexCreated( v );
-		return v;
+		return result;
 	}
 	//-------------------------------------------------------------------------
-	Agnode_t* Graph::createOrRetrieveVertex( const QString& label )
+	bool Graph::parseCachedFile( const QString& absFilePath,
+								 IncludeScanner::Mode mode,
+								 IncludeResolver* resolver,
+								 const ParseCache::FileStamp& stamp,
+								 ParsedFile* result,
+								 ParseCache::Entry* outdated )
 	{
-		if( !_vertices.contains( label ) )
-			this->createVertex( label );
+		Q_ASSERT( result );
+		*result = _emptyParsedFile( absFilePath );
+		if( !_findIncludes( absFilePath, mode, stamp, result, outdated ) )
+			return false;
 
-		return vertex( label );
+		_resolveIncludes( resolver, result );
+		return true;
 	}
 	//-------------------------------------------------------------------------
-	Agnode_t* Graph::vertex( const QString& label )
+	Graph::ParsedFile Graph::parseFileContent( const QString& absFilePath,
+											   IncludeScanner::Mode mode,
+											   IncludeResolver* resolver,
+											   const ParseCache::FileStamp& stamp,
+											   const ParseCache::Entry& outdated,
+											   const char* data, qint64 size )
 	{
-		Q_ASSERT( !label.isEmpty() && "Label cannot be empty!" );
-		if( _vertices.contains( label ) )
-			return _vertices[ label ];
+		ParsedFile result = _emptyParsedFile( absFilePath );
+		if( !data )
+			return result;
 
-		return 0;
+		_scanIncludes( absFilePath, mode, stamp, outdated, data, size, &result );
+		_resolveIncludes( resolver, &result );
+		return result;
 	}
 	//-------------------------------------------------------------------------
-	void Graph::createEdges( const QString& absPath, const QString& vertexLabel )
+	void Graph::createEdges( const ParsedFile& file )
 	{
-		Q_ASSERT( !absPath.isEmpty() && "Path is empty!" );
-		QString absFilePath = QString( "%1/%2" ).arg( absPath, vertexLabel );
+		if( !file.valid )
+			return;
 
-		if( !_parsedFiles.contains( absFilePath ) )
-		{
-			QFile f( absFilePath );
-			if( !f.open( QIODevice::ReadOnly | QIODevice::Text ) )
-				return;
+		Singleton<Project>::instance().watchFile( file.filePath );
 
-			_parsedFiles.insert( absFilePath, new QStringList );
+		_createEdges( file );
+	}
+	//-------------------------------------------------------------------------
+	void Graph::reserve( int vertices, int edges )
+	{
+		_dependencies.reserve( vertices, edges );
+		_changes.edges.reserve( _changes.edges.count() + edges );
+	}
+	//-------------------------------------------------------------------------
+	void Graph::commit()
+	{
+		_changes.vertexCount = _dependencies.vertexCount() - _changes.firstVertex;
+		_changes.mergedEdges = _dependencies.mergedEdges() - _changes.mergedEdges;
+		if( _changes.vertexCount || !_changes.edges.isEmpty() || _changes.mergedEdges )
+			emit changesCommitted( _changes );
 
-			QTextStream stream( &f );
-			QString fileContent = stream.readAll();
-			f.close();
+		_resetChanges();
+	}
+	//-------------------------------------------------------------------------
+	void Graph::_resetChanges()
+	{
+		_changes.firstVertex = _dependencies.vertexCount();
+		_changes.vertexCount = 0;
+		_changes.edges.clear();
+		_changes.mergedEdges = _dependencies.mergedEdges();
+	}
+	//-------------------------------------------------------------------------
+	bool Graph::_readIncludes( const QString& absFilePath,
+							   IncludeScanner::Mode mode,
+							   FileIdSet* seenFiles,
+							   ParsedFile* result )
+	{
+		//A single stat tells whether the cached includes are still valid,
+		//and whether the file has been reached through another path
+		ParseCache::FileStamp stamp;
+		FileIdSet::FileId id;
+		if( !ParseCache::FileStamp::read( absFilePath, &stamp, seenFiles ? &id : 0 ) )
+			return false;
 
-			//Before parsing includes, we remove every comment;
-			//By this way, commented include statements will not match anymore.
-			QString includeReg( "(//[^\\r\\n]*)|(/\\*([^*]"
-						 "|[\\r\\n]|(\\*+([^*/]|[\\r\\n])))*\\*+/)"
-			);
-			fileContent.remove( QRegExp( includeReg ) );
+#ifndef WIN32
+		if( seenFiles && !seenFiles->insert( id ) )
+		{
+			result->duplicate = true;
+			return false;
+		}
+#endif
+
+		ParseCache::Entry outdated;
+		if( _findIncludes( absFilePath, mode, stamp, result, &outdated ) )
+			return true;
+
+		FileReader reader;
+		if( !reader.open( absFilePath ) )
+			return false;
 
-			QRegExp rExp( "#\\s*include\\s*((<[^>]+>)|(\"[^\"]+\"))" );
-			int pos = 0;
+		_scanIncludes( absFilePath, mode, stamp, outdated,
+					   reader.data(), reader.size(), result
+		);
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	bool Graph::_findIncludes( const QString& absFilePath,
+							   IncludeScanner::Mode mode,
+							   const ParseCache::FileStamp& stamp,
+							   ParsedFile* result,
+							   ParseCache::Entry* outdated )
+	{
+		ParseCache::Entry entry = _parseCache.find( absFilePath, mode, stamp, outdated );
+		if( !entry )
+			return false;
 
-			while( ( pos = rExp.indexIn( fileContent, pos ) ) != -1 )
+		result->includes = entry->includes;
+		result->valid = true;
+		result->cached = true;
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	void Graph::_scanIncludes( const QString& absFilePath,
+							   IncludeScanner::Mode mode,
+							   const ParseCache::FileStamp& stamp,
+							   const ParseCache::Entry& outdated,
+							   const char* data, qint64 size,
+							   ParsedFile* result )
+	{
+		//Hash the content while it is still hot, right after reading it
+		quint64 hash = 0;
+		if( _parseCache.hashContents() )
+		{
+			hash = ParseCache::contentHash( data, size );
+			if( outdated && outdated->hash == hash )
 			{
-				QString match( rExp.cap( 1 ) );
-				QString currentInclude( match.mid( 1, match.length() - 2 ) );
-				_parsedFiles[ absFilePath ]->append( currentInclude );
-				pos += rExp.matchedLength();
+				ParseCache::Entry entry = _parseCache.refresh( absFilePath, mode, stamp, outdated );
+				result->includes = entry->includes;
+				result->valid = true;
+				result->cached = true;
+				return;
 			}
-			Singleton<Project>::instance().watchFile( absFilePath );
 		}
 
-		Agnode_t* src = createOrRetrieveVertex( vertexLabel );
-		foreach( QString inc, *_parsedFiles[ absFilePath ] )
-			_createEdge( src, createOrRetrieveVertex( inc ) );
+		IncludeScanner scanner( mode );
+		result->includes = scanner.scan( data, size );
+		_parseCache.insert( absFilePath, mode, stamp, hash, result->includes );
+		result->valid = true;
+		result->bytesScanned = scanner.bytesScanned();
+		result->bytesSkipped = scanner.bytesSkipped();
+	}
+	//-------------------------------------------------------------------------
+	Graph::ParsedFile Graph::_emptyParsedFile( const QString& absFilePath )
+	{
+		Q_ASSERT( !absFilePath.isEmpty() && "Path is empty!" );
+		ParsedFile result;
+		result.filePath = absFilePath;
+		result.valid = false;
+		result.cached = false;
+		result.bytesScanned = 0;
+		result.bytesSkipped = 0;
+		result.duplicate = false;
+		return result;
 	}
 	//-------------------------------------------------------------------------
-	void Graph::applyLayout()
+	void Graph::_resolveIncludes( IncludeResolver* resolver, ParsedFile* result )
+	{
+		if( !resolver )
+			return;
+
+		const QString& path = result->filePath;
+		result->canonicalPath = resolver->canonicalPath( path );
+		if( !result->valid )
+			return;
+
+		QString dir = path.left( path.lastIndexOf( '/' ) );
+		foreach( QString inc, result->includes )
+		{
+			const QString resolved = resolver->resolve( dir, inc );
+			result->resolvedIncludes.append( resolved );
+			result->canonicalIncludes.append(
+						resolved.isEmpty() ? QString() : resolver->canonicalPath( resolved ) );
+		}
+	}
+	//-------------------------------------------------------------------------
+	void Graph::applyLayout( const CancellationToken* cancellation )
 	{
 		Q_ASSERT( !_svgItem );
-		bool result = true;
-		QString errorMessage;
-		if( !_isPluginAvailable( _layoutAlgorithm, "layout" ) ||
-				!_isPluginAvailable( "svg", "render" ) )
+		if( CancellationToken::isCancelled( cancellation ) )
+		{
+			emit layoutCancelled();
+			return;
+		}
+
+		_dependencies.compact();
+		if( !_cycleFinder.run( _dependencies, cancellation ) )
+		{
+			emit layoutCancelled();
+			return;
+		}
+
+		_reduction.clear();
+		if( _transitiveReduction && !_reduction.run( _dependencies, _cycleFinder, cancellation ) )
+		{
+			emit layoutCancelled();
+			return;
+		}
+
+		Agraph_t* graph = _buildGraph();
+		const QString algorithm = _layoutAlgorithm;
+		QSharedPointer<LayoutJob> job( new LayoutJob( graph ) );
 		{
-			errorMessage = tr( "Required plugins unavailable!" );
-			result = false;
+			//Checked under the lock abandonLayout() takes, right after the
+			//token has been cancelled: either the cancellation is seen here,
+			//or abandonLayout() finds the job
+			QMutexLocker locker( &_layoutMutex );
+			if( CancellationToken::isCancelled( cancellation ) )
+			{
+				QMutexLocker graphvizLocker( &_graphvizMutex );
+				agclose( graph );
+				emit layoutCancelled();
+				return;
+			}
+
+			_layoutJob = job;
 		}
 
-		if( result && gvLayout( _context, _graph, G_STR( _layoutAlgorithm ) ) != 0 )
+		//gvLayout cannot be interrupted: from now on, this graph may be
+		//abandoned (or even deleted), and only job and static members are
+		//used until the job is known to be still wanted. The layout runs in
+		//a context of its own, so that no lock is held meanwhile
 		{
-			errorMessage = QString::fromUtf8( aglasterr() );
-			result = false;
+			QMutexLocker locker( &_graphvizMutex );
+			job->context = gvContext();
 		}
 
+		bool result = true;
+		bool laidOut = false;
+		QString errorMessage;
 		QString data;
-		if( result && !_renderDataAs( _graph, "svg", &data ) )
+		if( !_isAbandoned( job.data() ) )
+		{
+			if( !_isPluginAvailable( algorithm, "layout" ) ||
+					!_isPluginAvailable( "svg", "render" ) )
+			{
+				errorMessage = tr( "Required plugins unavailable!" );
+				result = false;
+			}
+
+			laidOut = result && gvLayout( job->context, graph, G_STR( algorithm ) ) == 0;
+			if( result && !laidOut )
+			{
+				QMutexLocker locker( &_graphvizMutex );
+				errorMessage = QString::fromUtf8( aglasterr() );
+				result = false;
+			}
+
+			if( result && !_renderDataAs( job->context, graph, "svg", &data ) )
+			{
+				errorMessage = tr( "Unable to render data as svg!" );
+				result = false;
+			}
+		}
+
+		QMutexLocker jobLocker( &job->mutex );
+		if( job->abandoned )
 		{
-			errorMessage = tr( "Unable to render data as svg!" );
-			result = false;
+			_freeGraph( graph, job->context );
+			return;
 		}
 
+		//Emitted under the job lock, so that this graph cannot be deleted
+		//meanwhile; _onLayoutApplied() takes the laid out graph
+		job->finished = true;
 		emit layoutApplied( result, result ? data : errorMessage );
 	}
 	//-------------------------------------------------------------------------
+	bool Graph::abandonLayout()
+	{
+		if( !_abandonLayoutJob() )
+			return false;
+
+		clearGraph();
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	bool Graph::_abandonLayoutJob()
+	{
+		QSharedPointer<LayoutJob> job;
+		{
+			QMutexLocker locker( &_layoutMutex );
+			job = _layoutJob;
+			_layoutJob.clear();
+		}
+
+		if( !job )
+			return false;
+
+		bool finished;
+		{
+			QMutexLocker locker( &job->mutex );
+			job->abandoned = true;
+			finished = job->finished;
+		}
+
+		//The layout thread is done with the graph, which is never taken now
+		if( finished )
+			_freeGraph( job->graph, job->context );
+
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	bool Graph::_isAbandoned( LayoutJob* job )
+	{
+		QMutexLocker locker( &job->mutex );
+		return job->abandoned;
+	}
+	//-------------------------------------------------------------------------
+	void Graph::_freeGraph( Agraph_t* graph, GVC_t* context )
+	{
+		QMutexLocker locker( &_graphvizMutex );
+		gvFreeLayout( context, graph );
+		agclose( graph );
+		gvFreeContext( context );
+	}
+	//-------------------------------------------------------------------------
 	void Graph::_onLayoutApplied( bool result, const QString& data )
 	{
+		Agraph_t* graph = 0;
+		GVC_t* context = 0;
+		{
+			QMutexLocker locker( &_layoutMutex );
+
+			//Abandoned after the layout finished: the graph is cleared
+			if( !_layoutJob )
+				return;
+
+			graph = _layoutJob->graph;
+			context = _layoutJob->context;
+			_layoutJob.clear();
+		}
+
 		if( !result )
 		{
+			_freeGraph( graph, context );
 			QMessageBox::critical(
 				parentWidget(),
 				tr( "Layout render error" ),
@@ -330,6 +660,15 @@ namespace depgraphV
 			return;
 		}
 
+		//The laid out graph replaces the one only holding the attributes
+		{
+			QMutexLocker locker( &_graphvizMutex );
+			agclose( _graph );
+		}
+
+		_graph = graph;
+		_layoutContext = context;
+
 		QXmlStreamReader xmlReader( data );
 		QSvgRenderer* r = new QSvgRenderer( &xmlReader );
 
@@ -345,16 +684,21 @@ namespace depgraphV
 		_drawn = true;
 	}
 	//-------------------------------------------------------------------------
+	void Graph::_onLayoutCancelled()
+	{
+		clearGraph();
+	}
+	//-------------------------------------------------------------------------
 	bool Graph::saveImage( const QString& filename, const QString& format ) const
 	{
 		Q_ASSERT( !filename.isEmpty() && "filename cannot be empty!" );
 		Q_ASSERT( !format.isEmpty() && "format cannot be empty!" );
 		bool result = false;
 
-		if( _isPluginAvailable( format, "loadimage" ) )
+		if( _layoutContext && _isPluginAvailable( format, "loadimage" ) )
 		{
 			result = gvRenderFilename(
-						 _context,
+						 _layoutContext,
 						 _graph,
 						 G_STR( format ),
 						 G_STR( filename )
@@ -362,11 +706,16 @@ namespace depgraphV
 
 			if( !result )
 			{
+				QString error;
+				{
+					QMutexLocker locker( &_graphvizMutex );
+					error = QString::fromUtf8( aglasterr() );
+				}
+
 				QMessageBox::critical(
 							parentWidget(),
 							tr( "Save as image" ),
-							tr( "Unable to save file;\n%1" )
-							.arg( QString::fromUtf8( aglasterr() ) )
+							tr( "Unable to save file;\n%1" ).arg( error )
 				);
 			}
 		}
@@ -381,8 +730,8 @@ namespace depgraphV
 		if( f.open( QIODevice::WriteOnly | QIODevice::Text ) )
 		{
 			QString data;
-			if( _isPluginAvailable( "dot", "render" )
-				&& _renderDataAs( _graph, "dot", &data ) )
+			if( _layoutContext && _isPluginAvailable( "dot", "render" )
+				&& _renderDataAs( _layoutContext, _graph, "dot", &data ) )
 			{
 				QTextStream stream( &f );
 				stream << data;
@@ -394,6 +743,44 @@ namespace depgraphV
 		return retValue;
 	}
 	//-------------------------------------------------------------------------
+	bool Graph::saveRedundantEdges( const QString& filename ) const
+	{
+		QFile f( filename );
+		if( !f.open( QIODevice::WriteOnly | QIODevice::Text ) )
+			return false;
+
+		QTextStream stream( &f );
+		stream.setCodec( "UTF-8" );
+		foreach( DependencyGraph::EdgeId e, _reduction.redundantEdges() )
+		{
+			stream << _dependencies.name( _dependencies.edgeSource( e ) ) << '\t'
+				   << _dependencies.name( _dependencies.target( e ) ) << '\n';
+		}
+
+		f.close();
+		return stream.status() == QTextStream::Ok;
+	}
+	//-------------------------------------------------------------------------
+	bool Graph::saveCycles( const QString& filename ) const
+	{
+		QFile f( filename );
+		if( !f.open( QIODevice::WriteOnly | QIODevice::Text ) )
+			return false;
+
+		QTextStream stream( &f );
+		stream.setCodec( "UTF-8" );
+		foreach( const QVector<DependencyGraph::VertexId>& cycle, _cycleFinder.cycles() )
+		{
+			for( int i = 0; i < cycle.count(); ++i )
+				stream << ( i ? "\t" : "" ) << _dependencies.name( cycle.at( i ) );
+
+			stream << '\n';
+		}
+
+		f.close();
+		return stream.status() == QTextStream::Ok;
+	}
+	//-------------------------------------------------------------------------
 	QStringList* Graph::pluginsListByKind( const QString& kind )
 	{
 		Q_ASSERT( !kind.isEmpty() && "Empty plugin kind!" );
@@ -431,11 +818,7 @@ namespace depgraphV
 	//-------------------------------------------------------------------------
 	void Graph::notifyFileHasChanged( const QString& absoluteFilePath )
 	{
-		if( !_parsedFiles.contains( absoluteFilePath ) )
-			return;
-
-		delete _parsedFiles[ absoluteFilePath ];
-		_parsedFiles.remove( absoluteFilePath );
+		_parseCache.invalidate( absoluteFilePath );
 	}
 	//-------------------------------------------------------------------------
 	void Graph::clearLayout()
@@ -447,16 +830,32 @@ namespace depgraphV
 			_svgItem = 0;
 		}
 
-		gvFreeLayout( _context, _graph );
+		//Only a graph taken from a finished layout has one, along with the
+		//context it has been laid out in
+		if( _layoutContext )
+		{
+			QMutexLocker locker( &_graphvizMutex );
+			gvFreeLayout( _layoutContext, _graph );
+			gvFreeContext( _layoutContext );
+			_layoutContext = 0;
+		}
+
 		_drawn = false;
 	}
 	//-------------------------------------------------------------------------
 	void Graph::clearGraph()
 	{
 		clearLayout();
-		_vertices.clear();
-		agclose( _graph );
-		NEW_GRAPH();
+		_dependencies.clear();
+		_cycleFinder.clear();
+		_reduction.clear();
+		_resetChanges();
+		{
+			QMutexLocker locker( &_graphvizMutex );
+			agclose( _graph );
+			_graph = NEW_GRAPH();
+		}
+
 		_restoreAttributes();
 	}
 	//-------------------------------------------------------------------------
@@ -467,32 +866,153 @@ namespace depgraphV
 		event->accept();
 	}
 	//-------------------------------------------------------------------------
-	Agedge_t* Graph::_createEdge( Agnode_t* src, Agnode_t* dest,
-								  const QString& label )
+	DependencyGraph::VertexId Graph::_fileVertex( const QString& path )
+	{
+		//Looked up first, to build the label only for new vertices
+		const DependencyGraph::VertexId v = _dependencies.vertex( path );
+		return v != DependencyGraph::NoVertex
+				? v : createVertex( path, QFileInfo( path ).fileName() );
+	}
+	//-------------------------------------------------------------------------
+	void Graph::_createEdges( const ParsedFile& file )
+	{
+		const DependencyGraph::VertexId src = _fileVertex( file.filePath );
+
+		for( int i = 0; i < file.includes.count(); ++i )
+		{
+			QString path = file.resolvedIncludes.value( i );
+			const DependencyGraph::VertexId dest = path.isEmpty()
+					? createVertex( IncludeResolver::includeName( file.includes[ i ] ) )
+					: _fileVertex( path );
+			//Including the same file more than once, under different #ifdef
+			//branches for instance, only increases the edge multiplicity
+			if( _dependencies.addEdge( src, dest ) )
+				_changes.edges.append( ( quint64( src ) << 32 ) | dest );
+		}
+	}
+	//-------------------------------------------------------------------------
+	Agraph_t* Graph::_buildGraph()
 	{
-		Q_ASSERT( src && dest && "src and dst vertices cannot be null!" );
+		//Names and attribute values are already stored in UTF-8: they are
+		//given to GraphViz without any conversion
+		_dependencies.compact();
+		const StringInterner& values = _dependencies.values();
+		const int count = _dependencies.vertexCount();
+		char empty[] = "";
+
+		//Parsers hand files over in whatever order they finish them: nodes
+		//and edges are created by name, so that the layout does not change
+		//from run to run
+		QVector<DependencyGraph::VertexId> order( count );
+		for( int v = 0; v < count; ++v )
+			order[ v ] = v;
+
+		std::sort( order.begin(), order.end(), ByName( _dependencies ) );
+
+		//cgraph keeps global state, shared with the graphs of the GUI thread
+		QMutexLocker locker( &_graphvizMutex );
+		Agraph_t* graph = NEW_GRAPH();
+		_applyAttributes( graph );
+
+		QVector<Agnode_t*> vertices( count );
+		foreach( DependencyGraph::VertexId v, order )
+		{
+			char* name = const_cast<char*>( _dependencies.utf8Name( v ) );
 #ifdef GraphViz_USE_CGRAPH
-		Agedge_t* e = agedge( _graph, src, dest, G_STR( label ), TRUE );
+			vertices[ v ] = agnode( graph, name, TRUE );
 #else
-		Agedge_t* e = agedge( _graph, src, dest );
+			vertices[ v ] = agnode( graph, name );
 #endif
-		if( !e )
+			if( !vertices[ v ] )
+				qWarning() << qPrintable( tr( "Invalid vertex:" ) ) << _dependencies.name( v );
+		}
+
+		foreach( const QString& name, _dependencies.vertexAttributeNames() )
+		{
+			const QByteArray n = name.toUtf8();
+			const QVector<StringInterner::Id>& column = *_dependencies.vertexColumn( name );
+			for( int v = 0; v < column.count(); ++v )
+			{
+				if( column.at( v ) != StringInterner::NoString && vertices[ v ] )
+					agsafeset( vertices[ v ], const_cast<char*>( n.constData() ),
+							   const_cast<char*>( values.utf8( column.at( v ) ) ), empty );
+			}
+		}
+
+		//The multiplicity of an edge becomes its weight, which dot uses to
+		//keep heavier edges shorter and straighter
+		char weight[] = "weight";
+		const bool reduced = !_reduction.redundantEdges().isEmpty();
+		QVector<Agedge_t*> edges( _dependencies.edgeCount() );
+		foreach( DependencyGraph::VertexId v, order )
 		{
-			qWarning() << qPrintable( tr( "Invalid egde:" ) ) << label;
-			return 0;
+			for( DependencyGraph::EdgeId e = _dependencies.outBegin( v );
+				 e < _dependencies.outEnd( v ); ++e )
+			{
+				Agnode_t* dest = vertices[ _dependencies.target( e ) ];
+				if( !vertices[ v ] || !dest || ( reduced && _reduction.isRedundant( e ) ) )
+					continue;
+
+#ifdef GraphViz_USE_CGRAPH
+				edges[ e ] = agedge( graph, vertices[ v ], dest, empty, TRUE );
+#else
+				edges[ e ] = agedge( graph, vertices[ v ], dest );
+#endif
+				if( edges[ e ] && _dependencies.multiplicity( e ) > 1 )
+				{
+					QByteArray m = QByteArray::number( _dependencies.multiplicity( e ) );
+					agsafeset( edges[ e ], weight, m.data(), empty );
+				}
+			}
 		}
 
-		emit edgeCreated( e );
-		return e;
+		foreach( const QString& name, _dependencies.edgeAttributeNames() )
+		{
+			const QByteArray n = name.toUtf8();
+			const QVector<StringInterner::Id>& column = *_dependencies.edgeColumn( name );
+			for( int e = 0; e < column.count(); ++e )
+			{
+				if( column.at( e ) != StringInterner::NoString && edges[ e ] )
+					agsafeset( edges[ e ], const_cast<char*>( n.constData() ),
+							   const_cast<char*>( values.utf8( column.at( e ) ) ), empty );
+			}
+		}
+
+		//Cycles override the color given by the attributes; edges between
+		//two vertices of the same component are part of a cycle
+		char color[] = "color";
+		char red[] = "red";
+		foreach( const QVector<DependencyGraph::VertexId>& cycle, _cycleFinder.cycles() )
+		{
+			foreach( DependencyGraph::VertexId v, cycle )
+			{
+				if( !vertices[ v ] )
+					continue;
+
+				agsafeset( vertices[ v ], color, red, empty );
+				const quint32 component = _cycleFinder.component( v );
+				for( DependencyGraph::EdgeId e = _dependencies.outBegin( v );
+					 e < _dependencies.outEnd( v ); ++e )
+				{
+					if( edges[ e ] &&
+						_cycleFinder.component( _dependencies.target( e ) ) == component )
+					{
+						agsafeset( edges[ e ], color, red, empty );
+					}
+				}
+			}
+		}
+
+		return graph;
 	}
 	//-------------------------------------------------------------------------
-	bool Graph::_renderDataAs( Agraph_t* graph, const QString& format,
-							   QString* outString )
+	bool Graph::_renderDataAs( GVC_t* context, Agraph_t* graph,
+							   const QString& format, QString* outString )
 	{
 		unsigned int length;
 		char* rawData = 0;
 		bool retValue = gvRenderData(
-							_context,
+							context,
 							graph,
 							G_STR( format ),
 							&rawData,
@@ -508,17 +1028,41 @@ namespace depgraphV
 	//-------------------------------------------------------------------------
 	void Graph::_restoreAttributes()
 	{
-		NameValuePair::iterator i = _graphAttributes.begin();
+		QMutexLocker locker( &_graphvizMutex );
+		_applyAttributes( _graph );
+	}
+	//-------------------------------------------------------------------------
+	void Graph::_applyAttributes( Agraph_t* graph ) const
+	{
+		NameValuePair::const_iterator i = _graphAttributes.begin();
 		for( ; i != _graphAttributes.end(); i++ )
-			setGraphAttribute( i.key(), i.value() );
+		{
+#ifdef GraphViz_USE_CGRAPH
+			agattr( graph, AGRAPH, G_STR( i.key() ), G_STR( i.value() ) );
+#else
+			agraphattr( graph, G_STR( i.key() ), G_STR( i.value() ) );
+#endif
+		}
 
 		i = _verticesAttributes.begin();
 		for( ; i != _verticesAttributes.end(); i++ )
-			setVerticesAttribute( i.key(), i.value() );
+		{
+#ifdef GraphViz_USE_CGRAPH
+			agattr( graph, AGNODE, G_STR( i.key() ), G_STR( i.value() ) );
+#else
+			agnodeattr( graph, G_STR( i.key() ), G_STR( i.value() ) );
+#endif
+		}
 
 		i = _edgesAttributes.begin();
 		for( ; i != _edgesAttributes.end(); i++ )
-			setEdgesAttribute( i.key(), i.value() );
+		{
+#ifdef GraphViz_USE_CGRAPH
+			agattr( graph, AGEDGE, G_STR( i.key() ), G_STR( i.value() ) );
+#else
+			agedgeattr( graph, G_STR( i.key() ), G_STR( i.value() ) );
+#endif
+		}
 	}
 	//-------------------------------------------------------------------------
 	void Graph::_setDefaultAttributes()
@@ -530,6 +1074,7 @@ namespace depgraphV
 		setHighQualityAA( Graph::defaultHighQualityAA() );
 		setRenderer( Graph::defaultRenderer() );
 		setLayoutAlgorithm( Graph::defaultLayoutAlgorithm() );
+		setTransitiveReduction( Graph::defaultTransitiveReduction() );
 
 		//Setting default graph attributes
 		setGraphAttribute( "splines", "spline" );
@@ -565,6 +1110,7 @@ namespace depgraphV
 			);
 			_availablePlugins.insert( kinds[ k ], new QStringList() );
 
+			QMutexLocker locker( &_graphvizMutex );
 			if( !_context )
 				_context = gvContext();
 
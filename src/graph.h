@@ -42,6 +42,30 @@
 #	include "foldersmodel.h"
 #endif
 
+#ifndef PARSECACHE_H
+#	include "parsecache.h"
+#endif
+
+#ifndef INCLUDERESOLVER_H
+#	include "includeresolver.h"
+#endif
+
+#ifndef CANCELLATIONTOKEN_H
+#	include "cancellationtoken.h"
+#endif
+
+#ifndef DEPENDENCYGRAPH_H
+#	include "dependencygraph.h"
+#endif
+
+#ifndef CYCLEFINDER_H
+#	include "cyclefinder.h"
+#endif
+
+#ifndef TRANSITIVEREDUCTION_H
+#	include "transitivereduction.h"
+#endif
+
 namespace depgraphV
 {
 	/**
@@ -53,6 +77,7 @@ namespace depgraphV
 		Q_PROPERTY( RendererType rendererType READ renderer WRITE setRenderer )
 		Q_PROPERTY( bool highQualityAA READ highQualityAA WRITE setHighQualityAA )
 		Q_PROPERTY( QString layoutAlgorithm READ layoutAlgorithm WRITE setLayoutAlgorithm )
+		Q_PROPERTY( bool transitiveReduction READ transitiveReduction WRITE setTransitiveReduction )
 		Q_ENUMS( RendererType )
 
 	public:
@@ -66,6 +91,43 @@ namespace depgraphV
 			OpenGL = 0x2
 		};
 
+		/**
+		 * @brief The ParsedFile struct holds the result of parseFile().
+		 */
+		struct ParsedFile
+		{
+			QString filePath;
+			QStringList includes;
+			//Absolute path of each include; empty when it cannot be resolved
+			QStringList resolvedIncludes;
+			//Paths without symbolic links of the file and of each resolved
+			//include, so that they need not be computed on the GUI thread
+			QString canonicalPath;
+			QStringList canonicalIncludes;
+			bool valid;
+			bool cached;
+			qint64 bytesScanned;
+			qint64 bytesSkipped;
+			//True if the file has been skipped, reached through another path
+			bool duplicate;
+		};
+
+		/**
+		 * @brief The ChangeSet struct lists what has been added to a graph
+		 * between two calls to commit().
+		 */
+		struct ChangeSet
+		{
+			//Vertex ids are dense: the new vertices are the ids from
+			//firstVertex to firstVertex + vertexCount - 1
+			DependencyGraph::VertexId firstVertex;
+			int vertexCount;
+			//New edges, packed as ( source << 32 ) | target
+			QVector<quint64> edges;
+			//Occurrences of edges which already existed
+			int mergedEdges;
+		};
+
 		/**
 		 * @brief Graph contructor.
 		 * @param parent The parent widget (default NULL).
@@ -114,6 +176,18 @@ namespace depgraphV
 		 */
 		static QString defaultLayoutAlgorithm() { return "dot"; }
 
+		/**
+		 * @return True if edges implied by a longer include path are left
+		 * out of the layout, false otherwise.
+		 */
+		bool transitiveReduction() const { return _transitiveReduction; }
+
+		/**
+		 * @brief Return the default value for transitiveReduction property
+		 * (false).
+		 */
+		static bool defaultTransitiveReduction() { return false; }
+
 		/**
 		 * @brief Return the graph attribute value.
 		 * @param name The name of the graph attribute.
@@ -139,41 +213,166 @@ namespace depgraphV
 		QString edgesAttribute( const QString& name ) const;
 
 		/**
-		 * @brief Create a new graph vertex.
-		 * @param label The label of the brand new vertex.
-		 * @return A vertex pointer if everything went fine, NULL otherwise.
+		 * @brief Change the value of an attribute of a single vertex,
+		 * overriding the one set by setVerticesAttribute().
+		 * @param value Attribute value; if empty, the attribute is unset.
 		 */
-		Agnode_t* createVertex( const QString& label );
+		void setVertexAttribute( DependencyGraph::VertexId v,
+								 const QString& name, const QString& value );
 
 		/**
-		 * @brief Create a new vertex with specified label only if that
-		 *        vertex wasn't previously created.
-		 * @param label The vertex label.
+		 * @brief Change the value of an attribute of a single edge,
+		 * overriding the one set by setEdgesAttribute(). Edge ids change
+		 * when new edges are added; use it once the graph is complete.
+		 * @param value Attribute value; if empty, the attribute is unset.
 		 */
-		Agnode_t* createOrRetrieveVertex( const QString& label );
+		void setEdgeAttribute( DependencyGraph::EdgeId e,
+							   const QString& name, const QString& value );
 
 		/**
-		 * @brief Get a previously created graph vertex by label.
-		 * @param label The label of the vertex.
-		 * @return The graph vertex with specified label, NULL otherwise.
+		 * @brief Make room for \a vertices more vertices and \a edges more
+		 * edges, to be added before the next commit().
 		 */
-		Agnode_t* vertex( const QString& label );
+		void reserve( int vertices, int edges );
+
+		/**
+		 * @brief Return the vertex with specified name, creating it if it
+		 * does not exist yet; a new vertex is reported by the next commit().
+		 * @param name The name which identifies the vertex (the absolute
+		 * path of its file, when known).
+		 * @param label The label shown for the vertex if it is created; if
+		 * empty, the name is shown.
+		 * @return The id of the vertex in dependencies().
+		 */
+		DependencyGraph::VertexId createVertex( const QString& name,
+												const QString& label = ""
+		);
+
+		/**
+		 * @brief Get a previously created graph vertex by name.
+		 * @param name The name of the vertex.
+		 * @return The id of the vertex, DependencyGraph::NoVertex otherwise.
+		 */
+		DependencyGraph::VertexId vertex( const QString& name ) const;
+
+		/**
+		 * @brief Return the vertices and edges of this graph; the GraphViz
+		 * graph is only generated from them by applyLayout().
+		 */
+		const DependencyGraph& dependencies() const { return _dependencies; }
 
 		//TODO Should I need getter methods for edges?
 
 		/**
-		 * @brief Create all the outgoing edges of the graph vertex with
-		 * label vertexLabel.
-		 * @param absPath The absolute path to the file
-		 * ( required to parse includes ).
-		 * @param vertexLabel The graph vertex label.
+		 * @brief Return the includes of the file at \a absFilePath, either
+		 * from the parse cache or by reading and scanning it (and caching
+		 * the result).
+		 * @param resolver If not null, it is used to fill
+		 * ParsedFile::resolvedIncludes and the canonical paths.
+		 * @param seenFiles If not null, the file is skipped (and marked as
+		 * ParsedFile::duplicate) if its device and inode are already in it.
+		 * @remarks This method is thread safe, it can run on any thread.
+		 */
+		static ParsedFile parseFile( const QString& absFilePath,
+									 IncludeScanner::Mode mode,
+									 IncludeResolver* resolver = 0,
+									 FileIdSet* seenFiles = 0
+		);
+
+		/**
+		 * @brief First half of parseFile(), for callers which read files by
+		 * themselves: fill \a result from the parse cache, if it holds the
+		 * includes of the file at \a absFilePath for \a stamp.
+		 * @param outdated If not null, it receives the entry which does not
+		 * match \a stamp anymore, to be passed to parseFileContent().
+		 * @return False on cache miss; the file content is needed then.
+		 * @remarks This method is thread safe, it can run on any thread.
+		 */
+		static bool parseCachedFile( const QString& absFilePath,
+									 IncludeScanner::Mode mode,
+									 IncludeResolver* resolver,
+									 const ParseCache::FileStamp& stamp,
+									 ParsedFile* result,
+									 ParseCache::Entry* outdated = 0
+		);
+
+		/**
+		 * @brief Second half of parseFile(): scan the \a size bytes at
+		 * \a data, already read from the file at \a absFilePath, and cache
+		 * the includes found. A null \a data means the file could not be
+		 * read; the result is not valid then.
+		 * @remarks This method is thread safe, it can run on any thread.
+		 */
+		static ParsedFile parseFileContent( const QString& absFilePath,
+											IncludeScanner::Mode mode,
+											IncludeResolver* resolver,
+											const ParseCache::FileStamp& stamp,
+											const ParseCache::Entry& outdated,
+											const char* data, qint64 size
+		);
+
+		/**
+		 * @brief Create the vertex of \a file and all of its outgoing edges,
+		 * and watch \a file for changes if it has just been parsed; they are
+		 * reported by the next commit().
+		 * @remarks GUI thread only.
+		 */
+		void createEdges( const ParsedFile& file );
+
+		/**
+		 * @brief Emit changesCommitted() once for everything added since the
+		 * previous commit(), if anything.
+		 */
+		void commit();
+
+		/**
+		 * @brief Return the scan mode used to parse the files of this graph.
+		 */
+		IncludeScanner::Mode scanMode() const { return _scanMode; }
+		void setScanMode( IncludeScanner::Mode mode ) { _scanMode = mode; }
+
+		/**
+		 * @brief Return the resolver used to map the includes of the files
+		 * of this graph to their absolute paths.
+		 */
+		IncludeResolver* resolver() { return &_resolver; }
+
+		/**
+		 * @brief Return the include cycles found by the last applyLayout().
+		 * @remarks Read it only once layoutApplied() has been emitted.
 		 */
-		void createEdges( const QString& absPath, const QString& vertexLabel );
+		const CycleFinder& cycleFinder() const { return _cycleFinder; }
 
 		/**
-		 * @brief Calculate the graph layout.
+		 * @brief Return the redundant edges found by the last applyLayout(),
+		 * if transitiveReduction is enabled.
+		 * @remarks Read it only once layoutApplied() has been emitted.
 		 */
-		void applyLayout();
+		const TransitiveReduction& reduction() const { return _reduction; }
+
+		/**
+		 * @brief Find the include cycles of dependencies(), find the
+		 * redundant edges if transitiveReduction is enabled, then generate
+		 * the GraphViz graph, without them and with the cycles highlighted,
+		 * and calculate its layout.
+		 * @param cancellation If not null and cancelled before GraphViz is
+		 * given the graph, layoutCancelled() is emitted and the graph is
+		 * cleared; once GraphViz runs, see abandonLayout().
+		 */
+		void applyLayout( const CancellationToken* cancellation = 0 );
+
+		/**
+		 * @brief Give up the layout GraphViz is calculating for
+		 * applyLayout(), which cannot be interrupted: the graph is cleared
+		 * right away, and the layout thread frees the graph it was given
+		 * once gvLayout returns. Neither layoutApplied() nor
+		 * layoutCancelled() is emitted then.
+		 * @return False if applyLayout() has not given GraphViz the graph
+		 * yet; cancel its token, it then stops by itself.
+		 * @remarks Call it from the thread owning this graph, after the
+		 * token of applyLayout() has been cancelled.
+		 */
+		bool abandonLayout();
 
 		/**
 		 * @return True if this graph has been drawn
@@ -198,6 +397,23 @@ namespace depgraphV
 		 */
 		bool saveDot( const QString& filename ) const;
 
+		/**
+		 * @brief Save the edges left out by the transitive reduction, one
+		 * per line: the including file and the included one, separated by
+		 * a tab. Each one is an include which can be removed.
+		 * @param filename The filename where to save.
+		 * @return True if the file has been saved successfully, false otherwise.
+		 */
+		bool saveRedundantEdges( const QString& filename ) const;
+
+		/**
+		 * @brief Save the include cycles, largest first, one per line: the
+		 * files making up the cycle, separated by tabs.
+		 * @param filename The filename where to save.
+		 * @return True if the file has been saved successfully, false otherwise.
+		 */
+		bool saveCycles( const QString& filename ) const;
+
 		/**
 		 * @brief Get plugins list by kind
 		 * @param kind The kind of plugin. Valid values are "render", "layout",
@@ -225,11 +441,16 @@ namespace depgraphV
 		 */
 		static void notifyFileHasChanged( const QString& absoluteFilePath );
 
+		/**
+		 * @brief Return the cache shared by all graphs to store parsed files.
+		 */
+		static ParseCache& parseCache() { return _parseCache; }
+
 	signals:
-		void vertexCreated( Agnode_t* );
-		void edgeCreated( Agedge_t* );
+		void changesCommitted( const Graph::ChangeSet& );
 
 		void layoutApplied( bool, const QString& );
+		void layoutCancelled();
 
 	public slots:
 		/**
@@ -248,6 +469,12 @@ namespace depgraphV
 
 		void setLayoutAlgorithm( const QString& value );
 
+		/**
+		 * @brief Enable (or disable) the transitive reduction; it applies
+		 * from the next layout.
+		 */
+		void setTransitiveReduction( bool value );
+
 		/**
 		 * @brief Change value of a graph attribute by name.
 		 * @param name Attribute name.
@@ -281,6 +508,7 @@ namespace depgraphV
 
 	private slots:
 		void _onLayoutApplied( bool, const QString& );
+		void _onLayoutCancelled();
 
 	private:
 		static unsigned short _instances;
@@ -289,13 +517,34 @@ namespace depgraphV
 
 		QGraphicsSvgItem* _svgItem;
 
+		//Only lists plugins: each layout gets a context of its own
 		static GVC_t* _context;
+		//Serializes the cgraph calls building, changing and freeing GraphViz
+		//graphs, the creation of contexts and the access to the error
+		//state, which share global state; it is never held while a layout
+		//is calculated
+		static QMutex _graphvizMutex;
 		Agraph_t* _graph;
-
-		QMap<QString, Agnode_t*> _vertices;
+		//The context _graph has been laid out in, null until it is drawn
+		GVC_t* _layoutContext;
+
+		struct LayoutJob;
+		//The layout GraphViz is working on, guarded by _layoutMutex
+		QSharedPointer<LayoutJob> _layoutJob;
+		QMutex _layoutMutex;
+
+		DependencyGraph _dependencies;
+		//Changes made since the last commit(); firstVertex and mergedEdges
+		//hold the values of the graph at that commit
+		ChangeSet _changes;
+		CycleFinder _cycleFinder;
+		bool _transitiveReduction;
+		TransitiveReduction _reduction;
 
 		static QMap<QString, QStringList*> _availablePlugins;
-		static QMap<QString, QStringList*> _parsedFiles;
+		static ParseCache _parseCache;
+		IncludeScanner::Mode _scanMode;
+		IncludeResolver _resolver;
 
 		typedef QMap<QString, QString> NameValuePair;
 		NameValuePair _graphAttributes;
@@ -306,28 +555,92 @@ namespace depgraphV
 		FoldersModel* _foldersModel;
 
 		/**
-		 * @brief Create a new edge between two vertices.
-		 * @param src The source vertex.
-		 * @param dest The destination vertex.
-		 * @param label Optional label of the new edge.
-		 * @return An edge pointer if everything went fine, or NULL if an error
-		 * occurred.
+		 * @brief Start a new change set from the current state of the graph.
 		 */
-		Agedge_t* _createEdge( Agnode_t* src, Agnode_t* dest,
-							   const QString& label = ""
+		void _resetChanges();
+
+		/**
+		 * @brief Return the vertex of the file at \a path, labelled with its
+		 * file name if it is created.
+		 */
+		DependencyGraph::VertexId _fileVertex( const QString& path );
+
+		/**
+		 * @brief Return a new GraphViz graph holding the vertices and edges
+		 * of dependencies(), and their attributes; those in a cycle are
+		 * colored on the GraphViz graph only.
+		 */
+		Agraph_t* _buildGraph();
+
+		/**
+		 * @brief Mark the running layout, if any, as abandoned.
+		 * @return False if GraphViz is not working on a layout.
+		 */
+		bool _abandonLayoutJob();
+		static bool _isAbandoned( LayoutJob* job );
+
+		/**
+		 * @brief Free \a graph along with its layout, if any, and the
+		 * \a context it has been laid out in.
+		 */
+		static void _freeGraph( Agraph_t* graph, GVC_t* context );
+
+		/**
+		 * @brief Create the vertex of \a file and an edge to each of its
+		 * includes; resolved includes are identified by their path, the
+		 * others by their name.
+		 */
+		void _createEdges( const ParsedFile& file );
+
+		/**
+		 * @brief Fill the includes of \a result from the parse cache or by
+		 * reading and scanning the file at \a absFilePath.
+		 * @return False if the file cannot be read.
+		 */
+		static bool _readIncludes( const QString& absFilePath,
+								   IncludeScanner::Mode mode,
+								   FileIdSet* seenFiles,
+								   ParsedFile* result
+		);
+
+		/**
+		 * @brief Fill the includes of \a result from the parse cache.
+		 * @return False on cache miss.
+		 */
+		static bool _findIncludes( const QString& absFilePath,
+								   IncludeScanner::Mode mode,
+								   const ParseCache::FileStamp& stamp,
+								   ParsedFile* result,
+								   ParseCache::Entry* outdated
+		);
+
+		/**
+		 * @brief Fill the includes of \a result by scanning \a data, unless
+		 * its hash matches the one of \a outdated.
+		 */
+		static void _scanIncludes( const QString& absFilePath,
+								   IncludeScanner::Mode mode,
+								   const ParseCache::FileStamp& stamp,
+								   const ParseCache::Entry& outdated,
+								   const char* data, qint64 size,
+								   ParsedFile* result
 		);
 
+		static ParsedFile _emptyParsedFile( const QString& absFilePath );
+		static void _resolveIncludes( IncludeResolver* resolver, ParsedFile* result );
+
 		/**
 		 * @brief Helper method used to "translate" the graph into different
 		 * formats.
+		 * @param context The context \a graph has been laid out in.
 		 * @param graph
 		 * @param format The selected format.
 		 * @param outString A string containing the graph representation in the
 		 * selected format.
 		 * @return True if everything went fine, false otherwise.
 		 */
-		static bool _renderDataAs( Agraph_t* graph, const QString& format,
-								   QString* outString
+		static bool _renderDataAs( GVC_t* context, Agraph_t* graph,
+								   const QString& format, QString* outString
 		);
 
 		/**
@@ -335,6 +648,11 @@ namespace depgraphV
 		 */
 		void _restoreAttributes();
 
+		/**
+		 * @brief Set the graph, vertices and edges attributes on \a graph.
+		 */
+		void _applyAttributes( Agraph_t* graph ) const;
+
 		void _setDefaultAttributes();
 
 		static void _lookForAvailablePlugins();
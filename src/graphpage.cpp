@@ -52,6 +52,9 @@ namespace depgraphV
 		_ui->layoutAlgorithm->setProperty( "type", "QComboBox" );
 		_ui->layoutAlgorithm->setProperty( "group", "layoutAlgorithm" );
 
+		_ui->transitiveReduction->setProperty( "type", "QCheckBox" );
+		_ui->transitiveReduction->setProperty( "group", "transitiveReduction" );
+
 		_ui->highQualityAA->setProperty( "type", "QCheckBox" );
 		_ui->highQualityAA->setProperty( "group", "highQualityAA" );
 
@@ -217,6 +220,9 @@ namespace depgraphV
 				else if( group == "layoutAlgorithm" )
 					g->setLayoutAlgorithm( newValue.toString() );
 
+				else if( group == "transitiveReduction" )
+					g->setTransitiveReduction( newValue.toBool() );
+
 				else if( group == "highQualityAA" )
 					g->setHighQualityAA( newValue.toBool() );
 
@@ -270,6 +276,11 @@ namespace depgraphV
 					   "",
 					   Graph::defaultLayoutAlgorithm()
 		);
+		p->addMapping( _ui->transitiveReduction,
+					   "transitiveReduction",
+					   "",
+					   Graph::defaultTransitiveReduction()
+		);
 		p->addMapping( _ui->highQualityAA,
 					   "highQualityAA",
 					   "",
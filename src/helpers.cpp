@@ -50,6 +50,24 @@ namespace depgraphV
 		int idx = combo->findText( text );
 		if( idx != -1 )
 			combo->setCurrentIndex( idx );
+#endif
+	}
+	//-------------------------------------------------------------------------
+	int Helpers::atomicLoad( const QAtomicInt& value )
+	{
+#if( QT_VERSION >= QT_VERSION_CHECK( 5, 0, 0 ) )
+		return value.load();
+#else
+		return value;
+#endif
+	}
+	//-------------------------------------------------------------------------
+	void Helpers::atomicStore( QAtomicInt& value, int newValue )
+	{
+#if( QT_VERSION >= QT_VERSION_CHECK( 5, 0, 0 ) )
+		value.store( newValue );
+#else
+		value = newValue;
 #endif
 	}
 	//-------------------------------------------------------------------------
@@ -82,6 +82,9 @@ namespace depgraphV
 
 		static QString pathShortener( const QString& path, ushort maxLen );
 
+		static int atomicLoad( const QAtomicInt& value );
+		static void atomicStore( QAtomicInt& value, int newValue );
+
 		template<typename T>
 		static bool QStringToType( const QString& s, T* value, typename std::enable_if<!std::is_same<bool, T>::value, T>::type* = 0 )
 		{
@@ -0,0 +1,178 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * includeresolver.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "includeresolver.h"
+
+namespace depgraphV
+{
+	IncludeResolver::IncludeResolver()
+	{
+	}
+	//-------------------------------------------------------------------------
+	void IncludeResolver::setIncludePaths( const QStringList& paths )
+	{
+		_includePaths.clear();
+		foreach( QString p, paths )
+			_includePaths.append( QDir::cleanPath( QDir( p ).absolutePath() ) );
+
+		clear();
+	}
+	//-------------------------------------------------------------------------
+	QString IncludeResolver::resolve( const QString& includingDir,
+									  const QString& spelling )
+	{
+		if( spelling.length() < 3 )
+			return QString();
+
+		bool angled = spelling.at( 0 ) == '<';
+		{
+			QReadLocker locker( &_lock );
+			if( angled )
+			{
+				QHash<QString, QString>::const_iterator it = _angled.constFind( spelling );
+				if( it != _angled.constEnd() )
+					return it.value();
+			}
+			else
+			{
+				QHash<QString, QHash<QString, QString> >::const_iterator dirIt =
+						_quoted.constFind( includingDir );
+				if( dirIt != _quoted.constEnd() )
+				{
+					QHash<QString, QString>::const_iterator it = dirIt->constFind( spelling );
+					if( it != dirIt->constEnd() )
+						return it.value();
+				}
+			}
+		}
+
+		QString name = includeName( spelling );
+		QString result;
+		if( QDir::isAbsolutePath( name ) )
+			result = _fileExists( QDir::cleanPath( name ) ) ? QDir::cleanPath( name ) : QString();
+		else if( angled )
+			result = _lookup( _includePaths, name );
+		else
+			result = _lookup( QStringList( includingDir ) + _includePaths, name );
+
+		QWriteLocker locker( &_lock );
+		if( angled )
+			_angled.insert( spelling, result );
+		else
+			_quoted[ includingDir ].insert( spelling, result );
+
+		return result;
+	}
+	//-------------------------------------------------------------------------
+	QString IncludeResolver::canonicalPath( const QString& absFilePath )
+	{
+		{
+			QReadLocker locker( &_lock );
+			QHash<QString, QString>::const_iterator it = _canonicalPaths.constFind( absFilePath );
+			if( it != _canonicalPaths.constEnd() )
+				return it.value();
+		}
+
+		QString result = QFileInfo( absFilePath ).canonicalFilePath();
+		QWriteLocker locker( &_lock );
+		_canonicalPaths.insert( absFilePath, result );
+		return result;
+	}
+	//-------------------------------------------------------------------------
+	void IncludeResolver::clear()
+	{
+		QWriteLocker locker( &_lock );
+		_angled.clear();
+		_quoted.clear();
+		_listings.clear();
+		_canonicalPaths.clear();
+	}
+	//-------------------------------------------------------------------------
+	QStringList IncludeResolver::splitIncludePaths( const QString& paths )
+	{
+		QStringList result;
+		foreach( QString p, paths.split( ';', QString::SkipEmptyParts ) )
+		{
+			p = p.trimmed();
+			if( !p.isEmpty() )
+				result.append( p );
+		}
+
+		return result;
+	}
+	//-------------------------------------------------------------------------
+	QString IncludeResolver::includeName( const QString& spelling )
+	{
+		return spelling.mid( 1, spelling.length() - 2 );
+	}
+	//-------------------------------------------------------------------------
+	QString IncludeResolver::_lookup( const QStringList& dirs, const QString& name )
+	{
+		foreach( QString dir, dirs )
+		{
+			QString candidate = QDir::cleanPath( dir + '/' + name );
+			if( _fileExists( candidate ) )
+				return candidate;
+		}
+
+		return QString();
+	}
+	//-------------------------------------------------------------------------
+	bool IncludeResolver::_fileExists( const QString& absFilePath )
+	{
+		int slash = absFilePath.lastIndexOf( '/' );
+		QString dir = slash > 0 ? absFilePath.left( slash ) : QString( "/" );
+		QString fileName = absFilePath.mid( slash + 1 );
+
+		{
+			QReadLocker locker( &_lock );
+			QHash<QString, QSet<QString> >::const_iterator it = _listings.constFind( dir );
+			if( it != _listings.constEnd() )
+				return it->contains( fileName );
+		}
+
+		//Missing directories get an empty listing as well
+		QSet<QString> listing;
+		foreach( QString entry, QDir( dir ).entryList( QDir::Files | QDir::Hidden |
+													   QDir::System ) )
+			listing.insert( entry );
+
+		QWriteLocker locker( &_lock );
+		_listings.insert( dir, listing );
+		return listing.contains( fileName );
+	}
+}
@@ -0,0 +1,132 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * includeresolver.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef INCLUDERESOLVER_H
+#define INCLUDERESOLVER_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The IncludeResolver class maps include spellings, as reported by
+	 * IncludeScanner, to the absolute path of the file they refer to.
+	 *
+	 * Quoted includes are looked up in the directory of the including file
+	 * first, then in includePaths(); angled includes in includePaths() only.
+	 *
+	 * Results are memoized by (including directory, spelling), or by spelling
+	 * alone for angled includes, and candidate files are checked against
+	 * in-memory listings of their directory, which are read once; so the
+	 * file system is hit once per directory rather than once per candidate.
+	 *
+	 * Canonical paths are memoized too, so that each file is resolved through
+	 * symbolic links only once.
+	 *
+	 * Every method is thread safe, except setIncludePaths().
+	 */
+	class IncludeResolver
+	{
+	public:
+		IncludeResolver();
+
+		const QStringList& includePaths() const { return _includePaths; }
+
+		/**
+		 * @brief Set the directories searched for included files, in order,
+		 * and forget every memoized result and directory listing.
+		 * @remarks Not thread safe; call it only while nothing is resolved.
+		 */
+		void setIncludePaths( const QStringList& paths );
+
+		/**
+		 * @brief Return the absolute path of the file included with
+		 * \a spelling (delimiters included) by a file in \a includingDir,
+		 * or an empty string if it cannot be found.
+		 */
+		QString resolve( const QString& includingDir, const QString& spelling );
+
+		/**
+		 * @brief Return the path of \a absFilePath without symbolic links,
+		 * or an empty string if the file does not exist.
+		 */
+		QString canonicalPath( const QString& absFilePath );
+
+		/**
+		 * @brief Forget every memoized result and directory listing, so that
+		 * files created meanwhile are found.
+		 */
+		void clear();
+
+		/**
+		 * @brief Split a list of include paths separated by ';', as stored
+		 * in project files, dropping empty items.
+		 */
+		static QStringList splitIncludePaths( const QString& paths );
+
+		/**
+		 * @brief Return \a spelling without its delimiters.
+		 */
+		static QString includeName( const QString& spelling );
+
+	private:
+		QStringList _includePaths;
+
+		QReadWriteLock _lock;
+		//Spelling -> path
+		QHash<QString, QString> _angled;
+		//Including dir -> spelling -> path
+		QHash<QString, QHash<QString, QString> > _quoted;
+		//Dir -> names of the files it contains
+		QHash<QString, QSet<QString> > _listings;
+		//Path -> canonical path
+		QHash<QString, QString> _canonicalPaths;
+
+		QString _lookup( const QStringList& dirs, const QString& name );
+		bool _fileExists( const QString& absFilePath );
+
+		Q_DISABLE_COPY( IncludeResolver )
+	};
+}
+
+#endif // INCLUDERESOLVER_H
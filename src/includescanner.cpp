@@ -0,0 +1,646 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * includescanner.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "includescanner.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || \
+	defined( _M_X64 ) || defined( _M_IX86 )
+#	define DEPGRAPHV_X86
+#	include <immintrin.h>
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	endif
+#endif
+
+//Allow the use of instructions which are not enabled for the whole build;
+//such functions must only be called after a runtime CPU check.
+#if defined( __GNUC__ )
+#	define DEPGRAPHV_TARGET( t ) __attribute__(( target( t ) ))
+#else
+#	define DEPGRAPHV_TARGET( t )
+#endif
+
+namespace depgraphV
+{
+	//Bytes which may change the lexer state; every other byte is skipped
+	//without further inspection. Newlines are not part of the set, since line
+	//starts are only needed when a directive or a comment is found, and they
+	//are looked up backwards at that time (see _foldLine).
+	static inline bool _isSpecial( char c )
+	{
+		switch( c )
+		{
+		case '#':
+		case '/':
+		case '"':
+		case '\'':
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	static inline bool _isBlank( char c )
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	static inline bool _isDigit( char c )
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	static inline bool _isIdentChar( char c )
+	{
+		return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) ||
+				_isDigit( c ) || c == '_';
+	}
+
+	static const char* _findScalar( const char* p, const char* end )
+	{
+		while( p < end && !_isSpecial( *p ) )
+			++p;
+
+		return p;
+	}
+
+#ifdef DEPGRAPHV_X86
+	static inline int _firstSetBit( unsigned int mask )
+	{
+#	ifdef _MSC_VER
+		unsigned long idx;
+		_BitScanForward( &idx, mask );
+		return static_cast<int>( idx );
+#	else
+		return __builtin_ctz( mask );
+#	endif
+	}
+
+	DEPGRAPHV_TARGET( "sse2" )
+	static const char* _findSSE2( const char* p, const char* end )
+	{
+		const __m128i hash = _mm_set1_epi8( '#' );
+		const __m128i slash = _mm_set1_epi8( '/' );
+		const __m128i dquote = _mm_set1_epi8( '"' );
+		const __m128i squote = _mm_set1_epi8( '\'' );
+
+		while( end - p >= 16 )
+		{
+			__m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+			__m128i m = _mm_or_si128(
+							_mm_or_si128( _mm_cmpeq_epi8( v, hash ),
+										  _mm_cmpeq_epi8( v, slash ) ),
+							_mm_or_si128( _mm_cmpeq_epi8( v, dquote ),
+										  _mm_cmpeq_epi8( v, squote ) )
+			);
+
+			unsigned int mask = _mm_movemask_epi8( m );
+			if( mask )
+				return p + _firstSetBit( mask );
+
+			p += 16;
+		}
+
+		return _findScalar( p, end );
+	}
+
+	DEPGRAPHV_TARGET( "avx2" )
+	static const char* _findAVX2( const char* p, const char* end )
+	{
+		const __m256i hash = _mm256_set1_epi8( '#' );
+		const __m256i slash = _mm256_set1_epi8( '/' );
+		const __m256i dquote = _mm256_set1_epi8( '"' );
+		const __m256i squote = _mm256_set1_epi8( '\'' );
+
+		while( end - p >= 32 )
+		{
+			__m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p ) );
+			__m256i m = _mm256_or_si256(
+							_mm256_or_si256( _mm256_cmpeq_epi8( v, hash ),
+											 _mm256_cmpeq_epi8( v, slash ) ),
+							_mm256_or_si256( _mm256_cmpeq_epi8( v, dquote ),
+											 _mm256_cmpeq_epi8( v, squote ) )
+			);
+
+			unsigned int mask = static_cast<unsigned int>( _mm256_movemask_epi8( m ) );
+			if( mask )
+				return p + _firstSetBit( mask );
+
+			p += 32;
+		}
+
+		return _findSSE2( p, end );
+	}
+#endif // DEPGRAPHV_X86
+
+	static bool _cpuSupports( IncludeScanner::Kernel k )
+	{
+		if( k == IncludeScanner::Scalar )
+			return true;
+
+#if defined( DEPGRAPHV_X86 ) && defined( __GNUC__ )
+		__builtin_cpu_init();
+		if( k == IncludeScanner::SSE2 )
+			return __builtin_cpu_supports( "sse2" );
+
+		return __builtin_cpu_supports( "avx2" );
+#elif defined( DEPGRAPHV_X86 ) && defined( _MSC_VER )
+		int info[ 4 ];
+		__cpuid( info, 1 );
+		if( k == IncludeScanner::SSE2 )
+			return ( info[ 3 ] & ( 1 << 26 ) ) != 0;
+
+		//AVX2 requires OS support for the YMM state (OSXSAVE + XCR0)
+		if( !( info[ 2 ] & ( 1 << 27 ) ) || ( _xgetbv( 0 ) & 0x6 ) != 0x6 )
+			return false;
+
+		__cpuidex( info, 7, 0 );
+		return ( info[ 1 ] & ( 1 << 5 ) ) != 0;
+#else
+		return false;
+#endif
+	}
+
+	static IncludeScanner::Kernel _bestKernel()
+	{
+		if( _cpuSupports( IncludeScanner::AVX2 ) )
+			return IncludeScanner::AVX2;
+
+		if( _cpuSupports( IncludeScanner::SSE2 ) )
+			return IncludeScanner::SSE2;
+
+		return IncludeScanner::Scalar;
+	}
+
+	IncludeScanner::FindFunc IncludeScanner::_kernelFunc( Kernel k )
+	{
+#ifdef DEPGRAPHV_X86
+		if( k == AVX2 )
+			return &_findAVX2;
+
+		if( k == SSE2 )
+			return &_findSSE2;
+#endif
+		Q_UNUSED( k );
+		return &_findScalar;
+	}
+
+	IncludeScanner::Kernel IncludeScanner::_kernel = _bestKernel();
+	IncludeScanner::FindFunc IncludeScanner::_find = _kernelFunc( _kernel );
+	//-------------------------------------------------------------------------
+	IncludeScanner::IncludeScanner( Mode mode )
+		: _begin( 0 ),
+		  _end( 0 ),
+		  _lineCheckFrom( 0 ),
+		  _tokenSeen( false ),
+		  _mode( mode ),
+		  _bytesScanned( 0 ),
+		  _bytesSkipped( 0 )
+	{
+	}
+	//-------------------------------------------------------------------------
+	QStringList IncludeScanner::scan( const char* data, qint64 size )
+	{
+		QStringList includes;
+		_begin = data;
+		_end = data + size;
+		_lineCheckFrom = data;
+		_tokenSeen = false;
+		const char* p = data;
+
+		//Skip the UTF-8 byte order mark, if any
+		if( size >= 3 && memcmp( p, "\xEF\xBB\xBF", 3 ) == 0 )
+		{
+			p += 3;
+			_lineCheckFrom = p;
+		}
+
+		if( _mode == Preamble )
+		{
+			_scanPreamble( p, &includes );
+			return includes;
+		}
+
+		_bytesScanned += size;
+		while( p < _end )
+		{
+			p = _find( p, _end );
+			if( p == _end )
+				break;
+
+			switch( *p )
+			{
+			case '#':
+				_foldLine( p );
+				p = _tokenSeen ? p + 1 : _directive( p + 1, &includes );
+				_tokenSeen = true;
+				_lineCheckFrom = p;
+				break;
+
+			case '/':
+				if( p + 1 < _end && ( p[ 1 ] == '/' || p[ 1 ] == '*' ) )
+				{
+					//Comments behave like blanks, so everything found on
+					//the current line so far must be checked now.
+					_foldLine( p );
+					p = p[ 1 ] == '/' ? _skipLineComment( p + 2 )
+									  : _skipBlockComment( p + 2 );
+					_lineCheckFrom = p;
+				}
+				else
+					++p;
+				break;
+
+			case '"':
+				p = _isRawStringPrefix( p ) ? _skipRawString( p + 1 )
+											: _skipQuoted( p + 1, '"' );
+				_tokenSeen = true;
+				_lineCheckFrom = p;
+				break;
+
+			case '\'':
+				p = _isDigitSeparator( p ) ? p + 1 : _skipQuoted( p + 1, '\'' );
+				_tokenSeen = true;
+				_lineCheckFrom = p;
+				break;
+
+			default:
+				++p;
+				break;
+			}
+		}
+
+		return includes;
+	}
+	//-------------------------------------------------------------------------
+	void IncludeScanner::resetStatistics()
+	{
+		_bytesScanned = 0;
+		_bytesSkipped = 0;
+	}
+	//-------------------------------------------------------------------------
+	bool IncludeScanner::setKernel( Kernel k )
+	{
+		if( !isKernelSupported( k ) )
+			return false;
+
+		_kernel = k;
+		_find = _kernelFunc( k );
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	bool IncludeScanner::isKernelSupported( Kernel k )
+	{
+		return _cpuSupports( k );
+	}
+	//-------------------------------------------------------------------------
+	const char* IncludeScanner::kernelName( Kernel k )
+	{
+		switch( k )
+		{
+		case SSE2:
+			return "SSE2";
+		case AVX2:
+			return "AVX2";
+		default:
+			return "scalar";
+		}
+	}
+	//-------------------------------------------------------------------------
+	const char* IncludeScanner::_skipSplices( const char* p ) const
+	{
+		while( p < _end && *p == '\\' )
+		{
+			if( p + 1 < _end && p[ 1 ] == '\n' )
+				p += 2;
+			else if( p + 2 < _end && p[ 1 ] == '\r' && p[ 2 ] == '\n' )
+				p += 3;
+			else
+				break;
+		}
+
+		return p;
+	}
+	//-------------------------------------------------------------------------
+	const char* IncludeScanner::_skipBlanks( const char* p ) const
+	{
+		for( ;; )
+		{
+			p = _skipSplices( p );
+			if( p >= _end )
+				return _end;
+
+			if( _isBlank( *p ) )
+				++p;
+			else if( *p == '/' && p + 1 < _end && p[ 1 ] == '*' )
+				p = _skipBlockComment( p + 2 );
+			else if( *p == '/' && p + 1 < _end && p[ 1 ] == '/' )
+				p = _skipLineComment( p + 2 );
+			else
+				return p;
+		}
+	}
+	//-------------------------------------------------------------------------
+	const char* IncludeScanner::_skipLineComment( const char* p ) const
+	{
+		while( p < _end )
+		{
+			p = static_cast<const char*>( memchr( p, '\n', _end - p ) );
+			if( !p )
+				return _end;
+
+			//Leave the newline to the caller, unless it has been spliced
+			if( _isNewLine( p ) )
+				return p;
+
+			++p;
+		}
+
+		return _end;
+	}
+	//-------------------------------------------------------------------------
+	const char* IncludeScanner::_skipBlockComment( const char* p ) const
+	{
+		while( p < _end )
+		{
+			p = static_cast<const char*>( memchr( p, '*', _end - p ) );
+			if( !p )
+				return _end;
+
+			p = _skipSplices( p + 1 );
+			if( p < _end && *p == '/' )
+				return p + 1;
+		}
+
+		return _end;
+	}
+	//-------------------------------------------------------------------------
+	const char* IncludeScanner::_skipQuoted( const char* p, char quote ) const
+	{
+		while( p < _end )
+		{
+			char c = *p;
+			if( c == quote )
+				return p + 1;
+
+			if( c == '\n' )
+			{
+				//Unterminated literal; the newline is left to the caller
+				return p;
+			}
+
+			if( c == '\\' )
+			{
+				if( p + 2 < _end && p[ 1 ] == '\r' && p[ 2 ] == '\n' )
+					p += 3;
+				else
+					p += 2;
+			}
+			else
+				++p;
+		}
+
+		return _end;
+	}
+	//-------------------------------------------------------------------------
+	const char* IncludeScanner::_skipRawString( const char* p ) const
+	{
+		//R"delimiter( ... )delimiter"
+		const char* delim = p;
+		while( p < _end && *p != '(' )
+		{
+			char c = *p;
+			if( p - delim >= 16 || _isBlank( c ) || c == '\n' || c == '\\' ||
+					c == ')' || c == '"' )
+			{
+				//Ill-formed raw string: treat it like an ordinary one.
+				return _skipQuoted( delim, '"' );
+			}
+			++p;
+		}
+
+		const int delimLen = p - delim;
+		while( p < _end )
+		{
+			p = static_cast<const char*>( memchr( p, ')', _end - p ) );
+			if( !p )
+				return _end;
+
+			++p;
+			if( _end - p > delimLen && p[ delimLen ] == '"' &&
+					memcmp( p, delim, delimLen ) == 0 )
+			{
+				return p + delimLen + 1;
+			}
+		}
+
+		return _end;
+	}
+	//-------------------------------------------------------------------------
+	const char* IncludeScanner::_skipLine( const char* p ) const
+	{
+		while( p < _end )
+		{
+			switch( *p )
+			{
+			case '\n':
+				if( _isNewLine( p ) )
+					return p + 1;
+
+				++p;
+				break;
+
+			case '/':
+				if( p + 1 < _end && p[ 1 ] == '/' )
+					p = _skipLineComment( p + 2 );
+				else if( p + 1 < _end && p[ 1 ] == '*' )
+					p = _skipBlockComment( p + 2 );
+				else
+					++p;
+				break;
+
+			case '"':
+			case '\'':
+				p = _skipQuoted( p + 1, *p );
+				break;
+
+			default:
+				++p;
+				break;
+			}
+		}
+
+		return _end;
+	}
+	//-------------------------------------------------------------------------
+	const char* IncludeScanner::_directive( const char* p,
+											QStringList* includes ) const
+	{
+		static const char keyword[] = "include";
+
+		p = _skipBlanks( p );
+		const char* q = p;
+		for( int i = 0; keyword[ i ]; ++i, ++q )
+		{
+			q = _skipSplices( q );
+			if( q >= _end || *q != keyword[ i ] )
+				return p;
+		}
+
+		q = _skipSplices( q );
+		if( q < _end && _isIdentChar( *q ) )
+			return p;
+
+		q = _skipBlanks( q );
+		if( q >= _end || ( *q != '<' && *q != '"' ) )
+			return q;
+
+		const char close = *q == '<' ? '>' : '"';
+		const char* name = ++q;
+		while( q < _end && *q != close && *q != '\n' )
+			++q;
+
+		if( q >= _end || *q != close || q == name )
+			return q;
+
+		includes->append( QString::fromUtf8( name - 1, q - name + 2 ) );
+		return q + 1;
+	}
+	//-------------------------------------------------------------------------
+	void IncludeScanner::_scanPreamble( const char* p, QStringList* includes )
+	{
+		//Directives are handled one logical line at a time; the first line
+		//starting with anything else than '#' ends the preamble.
+		for( ;; )
+		{
+			p = _skipBlanks( p );
+			if( p >= _end )
+				break;
+
+			if( *p == '\n' )
+				++p;
+			else if( *p == '#' )
+				p = _skipLine( _directive( p + 1, includes ) );
+			else
+				break;
+		}
+
+		_bytesScanned += p - _begin;
+		_bytesSkipped += _end - p;
+	}
+	//-------------------------------------------------------------------------
+	bool IncludeScanner::_isNewLine( const char* p ) const
+	{
+		Q_ASSERT( *p == '\n' );
+		if( p - 1 >= _begin && p[ -1 ] == '\\' )
+			return false;
+
+		return !( p - 2 >= _begin && p[ -1 ] == '\r' && p[ -2 ] == '\\' );
+	}
+	//-------------------------------------------------------------------------
+	bool IncludeScanner::_isRawStringPrefix( const char* quote ) const
+	{
+		if( quote == _begin || quote[ -1 ] != 'R' )
+			return false;
+
+		//Valid prefixes are R, LR, uR, UR and u8R
+		const char* r = quote - 1;
+		const char* t = r;
+		while( t > _begin && _isIdentChar( t[ -1 ] ) )
+			--t;
+
+		switch( r - t )
+		{
+		case 0:
+			return true;
+		case 1:
+			return *t == 'L' || *t == 'u' || *t == 'U';
+		case 2:
+			return t[ 0 ] == 'u' && t[ 1 ] == '8';
+		default:
+			return false;
+		}
+	}
+	//-------------------------------------------------------------------------
+	bool IncludeScanner::_isDigitSeparator( const char* quote ) const
+	{
+		//C++14 digit separators, as in 1'000'000
+		if( quote == _begin || !_isIdentChar( quote[ -1 ] ) ||
+				quote + 1 >= _end || !_isIdentChar( quote[ 1 ] ) )
+		{
+			return false;
+		}
+
+		const char* t = quote;
+		while( t > _begin && ( _isIdentChar( t[ -1 ] ) || t[ -1 ] == '\'' ||
+							   t[ -1 ] == '.' ) )
+		{
+			--t;
+		}
+
+		return _isDigit( *t ) || ( *t == '.' && _isDigit( t[ 1 ] ) );
+	}
+	//-------------------------------------------------------------------------
+	void IncludeScanner::_foldLine( const char* until )
+	{
+		//Look for the last line break since the previous check; a spliced
+		//newline doesn't end the logical line.
+		for( const char* q = until; q > _lineCheckFrom; )
+		{
+			if( *--q == '\n' && _isNewLine( q ) )
+			{
+				_tokenSeen = false;
+				_lineCheckFrom = q + 1;
+				break;
+			}
+		}
+
+		const char* p = _lineCheckFrom;
+		while( !_tokenSeen && p < until )
+		{
+			const char* n = _skipSplices( p );
+			if( n != p )
+				p = n;
+			else if( _isBlank( *p ) || *p == '\n' )
+				++p;
+			else
+				_tokenSeen = true;
+		}
+
+		_lineCheckFrom = until;
+	}
+} // end of depgraphV namespace
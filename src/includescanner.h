@@ -0,0 +1,193 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * includescanner.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef INCLUDESCANNER_H
+#define INCLUDESCANNER_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The IncludeScanner class is a single-pass, byte-level lexer which
+	 * extracts every \#include directive from a C/C++ source file.
+	 *
+	 * Input is handled as raw UTF-8 bytes; comments, string, character and raw
+	 * string literals are skipped and backslash line continuations are honored,
+	 * so that only real preprocessor directives are reported.
+	 */
+	class IncludeScanner
+	{
+	public:
+		/**
+		 * @brief The Kernel enum lists the implementations used to jump
+		 * between the bytes relevant to the lexer ('#', '/' and quotes);
+		 * every other byte is skipped without being inspected.
+		 */
+		enum Kernel
+		{
+			Scalar,
+			SSE2,
+			AVX2
+		};
+
+		/**
+		 * @brief The Mode enum defines how much of a file is scanned.
+		 */
+		enum Mode
+		{
+			/**
+			 * @brief Every directive in the file is reported.
+			 */
+			FullFile,
+
+			/**
+			 * @brief Scanning stops at the first token which is not part of
+			 * a preprocessor directive, so that only the includes found in
+			 * the file preamble are reported.
+			 */
+			Preamble
+		};
+
+		/**
+		 * @brief IncludeScanner constructor.
+		 * @param mode The scan mode (default FullFile).
+		 */
+		IncludeScanner( Mode mode = FullFile );
+
+		Mode mode() const { return _mode; }
+		void setMode( Mode mode ) { _mode = mode; }
+
+		/**
+		 * @brief Return the kernel in use. By default, the fastest one
+		 * supported by the running CPU is selected.
+		 */
+		static Kernel kernel() { return _kernel; }
+
+		/**
+		 * @brief Select the kernel used by every IncludeScanner instance.
+		 * @return False if \a k is not supported by the running CPU.
+		 * @remarks Not thread safe; call it before scanning starts.
+		 */
+		static bool setKernel( Kernel k );
+
+		/**
+		 * @return True if \a k is supported by the build and by the running
+		 * CPU, false otherwise.
+		 */
+		static bool isKernelSupported( Kernel k );
+
+		static const char* kernelName( Kernel k );
+
+		/**
+		 * @brief Scan \a size bytes starting at \a data.
+		 * @return The spelling of each included file, in order of appearance
+		 * and along with its delimiters (<> or ""), so that quoted and angled
+		 * includes can be told apart.
+		 */
+		QStringList scan( const char* data, qint64 size );
+
+		/**
+		 * @brief Convenience overload of scan().
+		 */
+		QStringList scan( const QByteArray& data )
+		{
+			return scan( data.constData(), data.size() );
+		}
+
+		/**
+		 * @brief Return how many bytes have been scanned by this instance.
+		 */
+		qint64 bytesScanned() const { return _bytesScanned; }
+
+		/**
+		 * @brief Return how many bytes have been left unscanned by this
+		 * instance, because they follow the preamble of their file.
+		 */
+		qint64 bytesSkipped() const { return _bytesSkipped; }
+
+		/**
+		 * @brief Reset bytesScanned() and bytesSkipped() to zero.
+		 */
+		void resetStatistics();
+
+	private:
+		typedef const char* ( *FindFunc )( const char*, const char* );
+		static Kernel _kernel;
+		static FindFunc _find;
+		static FindFunc _kernelFunc( Kernel k );
+
+		const char* _begin;
+		const char* _end;
+
+		/**
+		 * @brief Position from which the current line still has to be checked
+		 * for line breaks and tokens, and whether a token has already been
+		 * found on it. This allows to detect directives lazily, only when a
+		 * '#' is found.
+		 */
+		const char* _lineCheckFrom;
+		bool _tokenSeen;
+
+		Mode _mode;
+		qint64 _bytesScanned;
+		qint64 _bytesSkipped;
+
+		const char* _skipSplices( const char* p ) const;
+		const char* _skipBlanks( const char* p ) const;
+		const char* _skipLineComment( const char* p ) const;
+		const char* _skipBlockComment( const char* p ) const;
+		const char* _skipQuoted( const char* p, char quote ) const;
+		const char* _skipRawString( const char* p ) const;
+		const char* _skipLine( const char* p ) const;
+		const char* _directive( const char* p, QStringList* includes ) const;
+		void _scanPreamble( const char* p, QStringList* includes );
+
+		bool _isNewLine( const char* p ) const;
+		bool _isRawStringPrefix( const char* quote ) const;
+		bool _isDigitSeparator( const char* quote ) const;
+		void _foldLine( const char* until );
+	};
+}
+
+#endif // INCLUDESCANNER_H
@@ -36,6 +36,7 @@
  * THE SOFTWARE.
  */
 #include "mainwindow.h"
+#include "scanbenchmark.h"
 
 namespace depgraphV
 {
@@ -77,6 +78,12 @@ namespace depgraphV
 		printf( "\t-l (--with-log)\t\t= Enable log messages "
 				"(disabled by default).\n"
 		);
+		printf( "\t-b (--benchmark) <folder>\t= Measure include scanning "
+				"throughput on folder and quit.\n"
+		);
+		printf( "\t-c (--cold-benchmark) <folder>\t= Compare thread pool and "
+				"io_uring reads on folder with a cold page cache and quit.\n"
+		);
 	}
 
 	/**
@@ -160,7 +167,8 @@ int main( int argc, char* argv[] )
 		//First of all, check for valid option..
 		QStringList validOptions;
 		validOptions << "-h" << "--help" << "-V" << "--version"
-					 << "-l" << "--with-log";
+					 << "-l" << "--with-log" << "-b" << "--benchmark"
+					 << "-c" << "--cold-benchmark";
 		for( unsigned short i = 1; i < app.arguments().count(); i++ )
 		{
 			QString current = app.arguments()[ i ];
@@ -191,6 +199,27 @@ int main( int argc, char* argv[] )
 			else if( current == "--with-log" || current == "-l" )
 				logEnabled = true;
 
+			else if( current == "--benchmark" || current == "-b" ||
+					 current == "--cold-benchmark" || current == "-c" )
+			{
+				if( i + 1 >= app.arguments().count() )
+				{
+					printf( "WRONG USAGE: Missing folder for \"%s\"\n\n",
+							current.toStdString().c_str()
+					);
+					depgraphV::printHelp();
+					return 0;
+				}
+
+#ifdef WIN32
+				depgraphV::toggleConsole( true );
+#endif
+				if( current == "--cold-benchmark" || current == "-c" )
+					return depgraphV::ScanBenchmark::runColdCache( app.arguments()[ ++i ] );
+
+				return depgraphV::ScanBenchmark::run( app.arguments()[ ++i ] );
+			}
+
 			else
 				filename = current;
 		}
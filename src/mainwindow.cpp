@@ -38,6 +38,7 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "appconfig.h"
+#include "gitindex.h"
 #include "helpers.h"
 #include "project.h"
 
@@ -49,13 +50,56 @@
 
 namespace depgraphV
 {
+	/**
+	 * @brief Functor used to parse files on the global thread pool.
+	 */
+	struct FileParser
+	{
+		typedef Graph::ParsedFile result_type;
+
+		FileParser( IncludeScanner::Mode mode, IncludeResolver* resolver,
+					FileIdSet* seenFiles, QAtomicInt* parsedCount )
+			: _mode( mode ), _resolver( resolver ),
+			  _seenFiles( seenFiles ), _parsedCount( parsedCount )
+		{}
+
+		Graph::ParsedFile operator()( const QString& absFilePath ) const
+		{
+			Graph::ParsedFile file = Graph::parseFile( absFilePath, _mode, _resolver,
+													   _seenFiles
+			);
+			_parsedCount->ref();
+			return file;
+		}
+
+		IncludeScanner::Mode _mode;
+		IncludeResolver* _resolver;
+		FileIdSet* _seenFiles;
+		QAtomicInt* _parsedCount;
+	};
+	//-------------------------------------------------------------------------
 	MainWindow::MainWindow( QWidget* parent )
 		: QMainWindow( parent ),
 		_ui( new Ui::MainWindow ),
 		_project( 0 ),
 		_progressBar( new QProgressBar( this ) ),
+		_cancelButton( new QToolButton( this ) ),
+		_actionCancelDraw( new QAction( this ) ),
 		_netManager( new QNetworkAccessManager() ),
+		_databaseWatcher( 0 ),
+		_scanPipeline( 0 ),
+		_parseWatcher( 0 ),
 		_layoutWatcher( 0 ),
+		_drawnGraph( 0 ),
+		_progressCounter( 0 ),
+		_progressTimer( new QTimer( this ) ),
+		_bytesScanned( 0 ),
+		_bytesSkipped( 0 ),
+		_followIncludes( false ),
+		_followDepth( 0 ),
+		_maxFollowDepth( 0 ),
+		_maxFollowedFiles( 0 ),
+		_followedFiles( 0 ),
 		_currentRecentDocument( 0 ),
 		_imageFiltersUpdated( false )
 	{
@@ -72,6 +116,22 @@ namespace depgraphV
 		_progressBar->setMinimum( 0 );
 		_progressBar->setMaximum( 0 );
 
+		//Cancel action, reachable while toolbar and menus are disabled
+		_actionCancelDraw->setText( tr( "Cancel" ) );
+		_actionCancelDraw->setToolTip( tr( "Cancel drawing (Esc)" ) );
+		_actionCancelDraw->setShortcut( QKeySequence( Qt::Key_Escape ) );
+		_actionCancelDraw->setEnabled( false );
+		addAction( _actionCancelDraw );
+		connect( _actionCancelDraw, SIGNAL( triggered() ), this, SLOT( _onCancelDraw() ) );
+		_cancelButton->setDefaultAction( _actionCancelDraw );
+		_cancelButton->setAutoRaise( true );
+		_cancelButton->setVisible( false );
+		_ui->statusBar->addPermanentWidget( _cancelButton, 0 );
+
+		//Workers only bump _progressCounter; the bar is refreshed from here
+		_progressTimer->setInterval( 100 );
+		connect( _progressTimer, SIGNAL( timeout() ), this, SLOT( _updateProgress() ) );
+
 		//Dialogs
 		_config			= new AppConfig( this );
 		_aboutDlg		= new AboutDialog( this );
@@ -151,6 +211,10 @@ namespace depgraphV
 		//Restore last settings
 		_config->restore();
 
+		//Includes parsed by previous sessions; stale entries are detected
+		//when files are parsed, so there's nothing else to check here
+		Graph::parseCache().load();
+
 		_ui->statusBar->showMessage( QString( "%1 %2" ).arg( APP_NAME, tr( "ready" ) ) );
 	}
 	//-------------------------------------------------------------------------
@@ -202,7 +266,11 @@ namespace depgraphV
 		if( event )
 		{
 			if( event->type() == QEvent::LanguageChange )
+			{
 				_ui->retranslateUi( this );
+				_actionCancelDraw->setText( tr( "Cancel" ) );
+				_actionCancelDraw->setToolTip( tr( "Cancel drawing (Esc)" ) );
+			}
 
 			else if( event->type() == QEvent::LocaleChange )
 			{}
@@ -213,7 +281,15 @@ namespace depgraphV
 	//-------------------------------------------------------------------------
 	void MainWindow::closeEvent( QCloseEvent* event )
 	{
-		if( _layoutWatcher || !_discardProjectChanges() )
+		//Closing while drawing cancels the drawing first
+		if( _isDrawing() )
+		{
+			_onCancelDraw();
+			event->ignore();
+			return;
+		}
+
+		if( !_discardProjectChanges() )
 		{
 			event->ignore();
 			return;
@@ -221,6 +297,7 @@ namespace depgraphV
 
 		_showAboutDialog( true );
 		_config->save();
+		Graph::parseCache().save();
 		event->accept();
 		qApp->quit();
 	}
@@ -321,28 +398,48 @@ namespace depgraphV
 	//-------------------------------------------------------------------------
 	void MainWindow::_onDraw()
 	{
+		if( _isDrawing() )
+			return;
+
 		_ui->toolBar->setEnabled( false );
 		_ui->menuBar->setEnabled( false );
 		_ui->tabWidget->setCurrentTabUnclosable();
-		Graph* g = _project->currentGraph();
-
-		if( _project->currentValue( "scanByFolders" ).toBool() )
+		_drawnGraph = _project->currentGraph();
+		_cancellation.reset();
+		_actionCancelDraw->setEnabled( true );
+		_cancelButton->setVisible( true );
+
+		//Folders scanning, files parsing and layouting run in background;
+		//each stage starts the next one once it is finished
+		if( _project->currentValue( "useCompilationDatabase" ).toBool() )
+			_scanCompilationDatabase();
+		else if( _project->currentValue( "scanByFolders" ).toBool() )
 			_scanFolders();
 		else
-			_scanFiles( g->model()->checkedFiles() );
+			_scanFiles( _drawnGraph->model()->checkedFiles() );
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_onCancelDraw()
+	{
+		if( !_isDrawing() || _cancellation.isCancelled() )
+			return;
 
-		//Start layouting...
-		_startSlowOperation( tr( "Applying layout (it could take a while)..." ), 0 );
-		connect( g, SIGNAL( layoutApplied( bool, const QString& ) ),
-				 this, SLOT( _onGraphLayoutApplied( bool, const QString& ) ),
-				 Qt::UniqueConnection
-		);
+		_cancellation.cancel();
+		_actionCancelDraw->setEnabled( false );
+		_ui->statusBar->showMessage( tr( "Cancelling..." ) );
 
-		_layoutWatcher = new QFutureWatcher<void>();
-		_layoutWatcher->setFuture( QtConcurrent::run(
-							  g,
-							  &Graph::applyLayout )
-		);
+		//Wake up the stages which wait for work; each one ends as soon as
+		//it notices the cancellation, then _abortDrawing() cleans up
+		if( _parseWatcher )
+			_parseWatcher->cancel();
+
+		if( _scanPipeline )
+			_scanPipeline->cancel();
+
+		//GraphViz cannot be interrupted: its layout is left to finish in
+		//the background, while the graph is cleared right away
+		if( _layoutWatcher && _drawnGraph->abandonLayout() )
+			_onGraphLayoutCancelled();
 	}
 	//-------------------------------------------------------------------------
 	void MainWindow::_onClear( bool enableQuestion )
@@ -424,6 +521,68 @@ namespace depgraphV
 		}
 	}
 	//-------------------------------------------------------------------------
+	void MainWindow::_exportRedundantIncludes()
+	{
+		QString d = _config->lastDotSavePath();
+		if( d.isEmpty() )
+			d = QDir::currentPath();
+
+		QString path = QFileDialog::getSaveFileName(
+					this,
+					tr( "Select path and name of the redundant includes list" ),
+					d,
+					tr( "Tab separated values (*.tsv)" )
+		);
+
+		if( !Helpers::addExtension( path, ".tsv" ) )
+			return;
+
+		if( _project->currentGraph()->saveRedundantEdges( path ) )
+		{
+			_ui->statusBar->showMessage( tr( "File successfully saved." ) );
+			_config->setLastDotSavePath( QFileInfo( path ).absolutePath() );
+		}
+		else
+		{
+			QMessageBox::critical(
+						this,
+						tr( "Export redundant includes" ),
+						tr( "Unable to save file" )
+			);
+		}
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_exportIncludeCycles()
+	{
+		QString d = _config->lastDotSavePath();
+		if( d.isEmpty() )
+			d = QDir::currentPath();
+
+		QString path = QFileDialog::getSaveFileName(
+					this,
+					tr( "Select path and name of the include cycles list" ),
+					d,
+					tr( "Tab separated values (*.tsv)" )
+		);
+
+		if( !Helpers::addExtension( path, ".tsv" ) )
+			return;
+
+		if( _project->currentGraph()->saveCycles( path ) )
+		{
+			_ui->statusBar->showMessage( tr( "File successfully saved." ) );
+			_config->setLastDotSavePath( QFileInfo( path ).absolutePath() );
+		}
+		else
+		{
+			QMessageBox::critical(
+						this,
+						tr( "Export include cycles" ),
+						tr( "Unable to save file" )
+			);
+		}
+	}
+	//-------------------------------------------------------------------------
 	void MainWindow::_saveAsImage()
 	{
 		if( !_imageFiltersUpdated )
@@ -497,6 +656,12 @@ namespace depgraphV
 		_ui->actionClear->setEnabled( g->drawn() );
 		_ui->actionSave_as_dot->setEnabled( g->drawn() );
 		_ui->actionSave_as_Image->setEnabled( g->drawn() );
+		_ui->actionExport_redundant_includes->setEnabled(
+					g->drawn() && !g->reduction().redundantEdges().isEmpty()
+		);
+		_ui->actionExport_include_cycles->setEnabled(
+					g->drawn() && !g->cycleFinder().cycles().isEmpty()
+		);
 	}
 	//-------------------------------------------------------------------------
 	void MainWindow::_onGraphCountChanged( int count )
@@ -525,86 +690,280 @@ namespace depgraphV
 		_updateWindowTitle( false );
 	}
 	//-------------------------------------------------------------------------
-	void MainWindow::_scanFolder( const QFlags<QDir::Filter>& flags,
-								  QStringList* filesList,
-								  QFileInfo& dirInfo )
+	void MainWindow::_scanCompilationDatabase()
 	{
-		bool isGuiThread = QThread::currentThread() ==
-						   QCoreApplication::instance()->thread();
+		QString fileName = _project->currentValue( "compilationDatabase" ).toString();
+		_startSlowOperation( tr( "Reading compilation database..." ), 0 );
 
-		QStack<QFileInfo> stack;
-		stack.push( dirInfo );
-		QStringList nameFilters = _project->nameFilters();
-
-		while( !stack.isEmpty() )
-		{
-			if( isGuiThread )
-				QCoreApplication::processEvents();
-
-			QFileInfo folderInfo = stack.pop();
-			QString folder = folderInfo.filePath();
-			QDir d( folder );
-			//TODO emit folderFound signal?
-			foreach( QFileInfo childFolderInfo, d.entryInfoList( flags ) )
-				stack.push( childFolderInfo );
-
-			//Look for files in current folder
-			d.setNameFilters( nameFilters );
-			QFileInfoList fList = d.entryInfoList( QDir::NoDotAndDotDot | QDir::Files );
-			foreach( QFileInfo fileEntry, fList )
-				filesList->append( fileEntry.filePath() );
-		}
+		_databaseWatcher = new QFutureWatcher<CompilationDatabase>();
+		connect( _databaseWatcher, SIGNAL( finished() ),
+				 this, SLOT( _onCompilationDatabaseLoaded() )
+		);
+		_databaseWatcher->setFuture( QtConcurrent::run(
+										 &CompilationDatabase::fromFile,
+										 QDir::fromNativeSeparators( fileName ) )
+		);
 	}
 	//-------------------------------------------------------------------------
-	void MainWindow::_scanFolders() const
+	void MainWindow::_scanFolders()
 	{
 		QStringList folders = _project->currentValue( "selectedFolders" ).toStringList();
-		QStringList filesList;
-		_startSlowOperation(
-					tr( "Scanning folders..." ),
-					folders.count()
-		);
-		QFlags<QDir::Filter> flags = QDir::NoDotAndDotDot | QDir::Dirs;
-
-		if( _project->currentValue( "includeHiddenFolders" ).toBool() )
-			flags |= QDir::Hidden;
 
-		QStringList::const_iterator it = folders.begin();
-		for( ; it != folders.end(); it++ )
+		//The index of a git checkout lists the tracked files, no need to
+		//walk the tree
+		QStringList trackedFiles;
+		if( _project->currentValue( "useGitIndex" ).toBool() &&
+			_collectTrackedFiles( folders, &trackedFiles ) )
 		{
-			QFileInfoList infos = QDir( *it ).entryInfoList( flags );
-			if( infos.isEmpty() )
-				continue;
+			_scanFiles( trackedFiles );
+			return;
+		}
 
-			auto memberFuncPtr = std::bind(
-									 &MainWindow::_scanFolder,
-									 const_cast<MainWindow*>( this ),
-									 flags,
-									 &filesList,
-									 std::placeholders::_1
-			);
+		//The number of files is not known in advance
+		_startSlowOperation( tr( "Scanning folders and analyzing files..." ), 0 );
+		_prepareParsing();
+
+		Helpers::atomicStore( _progressCounter, 0 );
+		_progressTimer->start();
+
+		//Files are parsed while folders are still being walked
+		Graph* g = _drawnGraph;
+		FolderWalker walker = _createFolderWalker();
+		walker.setCancellationToken( &_cancellation );
+		walker.setSeenFiles( &_seenFiles );
+		walker.setHonorGitignore( _project->currentValue( "honorGitignore" ).toBool() );
+		_scanPipeline = new ScanPipeline( walker, g->scanMode(), g->resolver(), this );
+		if( _config->ioUringReads() )
+			_scanPipeline->setIoUringQueueDepth( _config->ioUringQueueDepth() );
+
+		connect( _scanPipeline, SIGNAL( resultsReady() ),
+				 this, SLOT( _onPipelineResultsReady() )
+		);
+		connect( _scanPipeline, SIGNAL( finished() ),
+				 this, SLOT( _onPipelineFinished() )
+		);
+		_scanPipeline->start( folders, &_progressCounter, &_cancellation );
+	}
+	//-------------------------------------------------------------------------
+	bool MainWindow::_collectTrackedFiles( const QStringList& folders, QStringList* files )
+	{
+		QElapsedTimer timer;
+		timer.start();
+
+		//Tracked files are filtered like walked ones; git already leaves out
+		//the untracked files its ignore rules apply to
+		FolderWalker filter = _createFolderWalker();
+		QStringList result;
+		foreach( QString folder, folders )
+		{
+			GitIndex index;
+			if( !index.load( folder ) )
+			{
+				qDebug() << qPrintable( index.errorString() );
+				return false;
+			}
 
-			//TODO Cancel...
-			QtConcurrent::blockingMap( infos, memberFuncPtr );
-			_progressBar->setValue( _progressBar->value() + 1 );
+			QString root = QDir::cleanPath( QFileInfo( folder ).absoluteFilePath() );
+			foreach( const QString& path, index.files() )
+			{
+				if( filter.accepts( root, path ) )
+					result.append( path );
+			}
 		}
 
-		_scanFiles( filesList );
+		qDebug() << qPrintable(
+						tr( "Enumerated %1 files from git indexes in %2 ms" )
+						.arg( result.count() ).arg( timer.elapsed() )
+		);
+
+		*files = result;
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	FolderWalker MainWindow::_createFolderWalker() const
+	{
+		FolderWalker walker( _project->nameFilters(),
+							 _project->currentValue( "includeHiddenFolders" ).toBool()
+		);
+		walker.setExcludeRules( ExcludeRules( ExcludeRules::splitPatterns(
+												  _project->currentValue( "excludePatterns" ).toString() ) )
+		);
+		return walker;
 	}
 	//-------------------------------------------------------------------------
-	void MainWindow::_scanFiles( const QStringList& files ) const
+	void MainWindow::_scanFiles( const QStringList& files,
+								 const QStringList& extraIncludePaths )
 	{
 		_startSlowOperation( tr( "Analyzing files..." ), files.count() );
+		_prepareParsing( extraIncludePaths );
 
-		//TODO blockingMap here instead of the following "simple" foreach loop?
+		QStringList toParse;
 		foreach( QString path, files )
+			toParse.append( QFileInfo( path ).absoluteFilePath() );
+
+		Helpers::atomicStore( _progressCounter, 0 );
+		_progressTimer->start();
+		_parseFiles( toParse );
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_prepareParsing( const QStringList& extraIncludePaths )
+	{
+		Graph* g = _drawnGraph;
+		g->setScanMode( _project->currentValue( "preambleOnly" ).toBool()
+						? IncludeScanner::Preamble
+						: IncludeScanner::FullFile
+		);
+		_bytesScanned = 0;
+		_bytesSkipped = 0;
+		Graph::parseCache().setHashContents( _config->hashFileContents() );
+		g->resolver()->setIncludePaths( IncludeResolver::splitIncludePaths(
+											_project->currentValue( "includePaths" ).toString() )
+										+ extraIncludePaths
+		);
+
+		_followIncludes = _project->currentValue( "followIncludes" ).toBool();
+		_maxFollowDepth = _project->currentValue( "followIncludesDepth" ).toInt();
+		_maxFollowedFiles = _project->currentValue( "followIncludesMaxFiles" ).toInt();
+		_followDepth = 0;
+		_followedFiles = 0;
+		_visitedFiles.clear();
+		_discoveredIncludes.clear();
+		_nextFiles.clear();
+		_parsedAhead.clear();
+		_paths.clear();
+		_seenFiles.clear();
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_parseFiles( const QStringList& absFilePaths )
+	{
+		Graph* g = _drawnGraph;
+		_parseWatcher = new QFutureWatcher<Graph::ParsedFile>();
+		connect( _parseWatcher, SIGNAL( resultsReadyAt( int, int ) ),
+				 this, SLOT( _onFilesParsed( int, int ) )
+		);
+		connect( _parseWatcher, SIGNAL( finished() ),
+				 this, SLOT( _onFilesParsingFinished() )
+		);
+		_parseWatcher->setFuture( QtConcurrent::mapped(
+									  absFilePaths,
+									  FileParser( g->scanMode(), g->resolver(),
+												  &_seenFiles, &_progressCounter ) )
+		);
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_handleParsedFile( const Graph::ParsedFile& file )
+	{
+		if( file.duplicate )
+			return;
+
+		_drawnGraph->createEdges( file );
+		_bytesScanned += file.bytesScanned;
+		_bytesSkipped += file.bytesSkipped;
+
+		if( _followIncludes )
+			_followIncludesOf( file );
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_markSelectedFile( const Graph::ParsedFile& file )
+	{
+		//A selected file may have been reached by following the includes
+		//of another one first: it must not be parsed again
+		const StringInterner::Id pathId = _paths.intern( file.filePath );
+		_discoveredIncludes.insert( pathId );
+		if( file.canonicalPath.isEmpty() )
+			return;
+
+		const StringInterner::Id canonicalId = _paths.intern( file.canonicalPath );
+		if( _visitedFiles.contains( canonicalId ) )
+			_parsedAhead.insert( pathId );
+		else
+			_visitedFiles.insert( canonicalId );
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_followIncludesOf( const Graph::ParsedFile& file )
+	{
+		if( _followDepth >= _maxFollowDepth )
+			return;
+
+		for( int i = 0; i < file.resolvedIncludes.count(); ++i )
 		{
-			QFileInfo f( path );
-			_project->currentGraph()->createEdges( f.absolutePath(), f.fileName() );
-			_progressBar->setValue( _progressBar->value() + 1 );
+			if( _followedFiles >= _maxFollowedFiles )
+				return;
+
+			const QString& path = file.resolvedIncludes.at( i );
+			if( path.isEmpty() )
+				continue;
+
+			const StringInterner::Id pathId = _paths.intern( path );
+			if( _discoveredIncludes.contains( pathId ) )
+				continue;
+
+			//Different paths may lead to the same file (symbolic links,
+			//for instance); it is parsed only once
+			_discoveredIncludes.insert( pathId );
+			const QString& canonicalPath = file.canonicalIncludes.at( i );
+			if( canonicalPath.isEmpty() )
+				continue;
+
+			const StringInterner::Id canonicalId = _paths.intern( canonicalPath );
+			if( _visitedFiles.contains( canonicalId ) )
+				continue;
+
+			_visitedFiles.insert( canonicalId );
+			_nextFiles.append( path );
+			_followedFiles++;
 		}
 	}
 	//-------------------------------------------------------------------------
+	void MainWindow::_applyLayout()
+	{
+		Graph* g = _drawnGraph;
+		_startSlowOperation( tr( "Applying layout (it could take a while)..." ), 0 );
+		connect( g, SIGNAL( layoutApplied( bool, const QString& ) ),
+				 this, SLOT( _onGraphLayoutApplied( bool, const QString& ) ),
+				 Qt::UniqueConnection
+		);
+		connect( g, SIGNAL( layoutCancelled() ),
+				 this, SLOT( _onGraphLayoutCancelled() ),
+				 Qt::UniqueConnection
+		);
+
+		g->setTransitiveReduction( _project->currentValue( "transitiveReduction" ).toBool() );
+		_layoutWatcher = new QFutureWatcher<void>();
+		_layoutWatcher->setFuture( QtConcurrent::run(
+							  g,
+							  &Graph::applyLayout,
+							  &_cancellation )
+		);
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_finishDrawing( const QString& statusBarMessage )
+	{
+		_actionCancelDraw->setEnabled( false );
+		_cancelButton->setVisible( false );
+		_ui->toolBar->setEnabled( true );
+		_ui->menuBar->setEnabled( true );
+		_ui->tabWidget->resetUnclosableTab();
+		_progressBar->setVisible( false );
+		_ui->statusBar->showMessage( statusBarMessage );
+		//Force toolbar buttons update
+		_onCurrentTabChanged( _ui->tabWidget->currentIndex() );
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_abortDrawing()
+	{
+		_progressTimer->stop();
+		_nextFiles.clear();
+		_parsedAhead.clear();
+		_drawnGraph->clearGraph();
+		_finishDrawing( tr( "Drawing cancelled" ) );
+	}
+	//-------------------------------------------------------------------------
+	bool MainWindow::_isDrawing() const
+	{
+		return _databaseWatcher || _scanPipeline || _parseWatcher || _layoutWatcher;
+	}
+	//-------------------------------------------------------------------------
 	void MainWindow::_doClearGraph() const
 	{
 		//TODO
@@ -981,17 +1340,247 @@ namespace depgraphV
 		}
 	}
 	//-------------------------------------------------------------------------
+	void MainWindow::_onCompilationDatabaseLoaded()
+	{
+		CompilationDatabase db = _databaseWatcher->result();
+		_databaseWatcher->deleteLater();
+		_databaseWatcher = 0;
+
+		if( _cancellation.isCancelled() )
+		{
+			_abortDrawing();
+			return;
+		}
+
+		if( !db.isValid() )
+		{
+			_finishDrawing( tr( "Unable to read the compilation database" ) );
+			QMessageBox::warning( this, tr( "Compilation database" ), db.errorString() );
+			return;
+		}
+
+		qDebug() << qPrintable(
+						tr( "Compilation database: %1 entries, %2 files, "
+							"%3 include paths" ).arg( db.entriesCount() )
+						.arg( db.files().count() ).arg( db.includePaths().count() )
+		);
+
+		_scanFiles( db.files(), db.includePaths() );
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_onPipelineResultsReady()
+	{
+		//Results still queued are dropped along with the pipeline
+		if( _cancellation.isCancelled() )
+			return;
+
+		Graph::ParsedFile file;
+		while( _scanPipeline->takeResult( &file ) )
+		{
+			if( _followIncludes )
+				_markSelectedFile( file );
+
+			_handleParsedFile( file );
+		}
+
+		_drawnGraph->commit();
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_onPipelineFinished()
+	{
+		_onPipelineResultsReady();
+
+		foreach( QString line, _scanPipeline->statistics() )
+			qDebug() << qPrintable( line );
+
+		_scanPipeline->deleteLater();
+		_scanPipeline = 0;
+
+		if( _cancellation.isCancelled() )
+			_abortDrawing();
+		else
+			_finishParsingLevel();
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_onFilesParsed( int begin, int end )
+	{
+		if( _cancellation.isCancelled() )
+			return;
+
+		//Files of a batch are added to the graph in bulk, reported at once
+		QList<Graph::ParsedFile> files;
+		int includes = 0;
+		for( int i = begin; i < end; ++i )
+		{
+			files.append( _parseWatcher->resultAt( i ) );
+			includes += files.last().includes.count();
+		}
+
+		_drawnGraph->reserve( files.count(), includes );
+		foreach( const Graph::ParsedFile& file, files )
+		{
+			if( _followIncludes && _followDepth == 0 )
+				_markSelectedFile( file );
+
+			_handleParsedFile( file );
+		}
+
+		_drawnGraph->commit();
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_onFilesParsingFinished()
+	{
+		_parseWatcher->deleteLater();
+		_parseWatcher = 0;
+
+		if( _cancellation.isCancelled() )
+			_abortDrawing();
+		else
+			_finishParsingLevel();
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_finishParsingLevel()
+	{
+		QStringList files;
+		foreach( QString path, _nextFiles )
+		{
+			if( !_parsedAhead.contains( _paths.find( path ) ) )
+				files.append( path );
+		}
+
+		_nextFiles.clear();
+		_parsedAhead.clear();
+
+		//Parse the files included by the level just parsed
+		if( !files.isEmpty() )
+		{
+			_followDepth++;
+			_progressBar->setMaximum( Helpers::atomicLoad( _progressCounter ) + files.count() );
+			_parseFiles( files );
+			return;
+		}
+
+		_progressTimer->stop();
+
+		if( _followIncludes )
+		{
+			qDebug() << qPrintable(
+							tr( "Followed %1 included files over %2 levels" )
+							.arg( _followedFiles ).arg( _followDepth )
+			);
+		}
+
+		qDebug() << qPrintable(
+						tr( "Skipped %1 files and folders reached through "
+							"more than one path" ).arg( _seenFiles.duplicates() )
+		);
+
+		qDebug() << qPrintable(
+						tr( "Scanned %1 of %2 bytes (%3 bytes skipped after "
+							"file preambles)" ).arg( _bytesScanned )
+						.arg( _bytesScanned + _bytesSkipped ).arg( _bytesSkipped )
+		);
+
+		ParseCache& cache = Graph::parseCache();
+		qDebug() << qPrintable(
+						tr( "Parse cache: %1 entries, %2 hits, %3 misses, "
+							"%4 evictions, %5 re-parses avoided by content "
+							"hash" ).arg( cache.count() )
+						.arg( cache.hits() ).arg( cache.misses() )
+						.arg( cache.evictions() ).arg( cache.reparsesAvoided() )
+		);
+
+		//Saved while the layout runs, rather than only on exit, so that the
+		//files parsed by this draw survive a crash
+		QtConcurrent::run( &cache, &ParseCache::save, ParseCache::defaultFileName() );
+
+		_applyLayout();
+	}
+	//-------------------------------------------------------------------------
 	void MainWindow::_onGraphLayoutApplied( bool result, const QString& )
 	{
-		_ui->toolBar->setEnabled( true );
-		_ui->menuBar->setEnabled( true );
-		_ui->tabWidget->resetUnclosableTab();
-		_progressBar->setVisible( false );
-		_ui->statusBar->showMessage(
-			result ? tr( "All done" ) : tr( "An error occurred while layouting..." )
+		//Queued right before the layout was abandoned
+		if( !_layoutWatcher )
+			return;
+
+		QString message = tr( "An error occurred while layouting..." );
+		if( result )
+		{
+			const DependencyGraph& d = _drawnGraph->dependencies();
+			qDebug() << qPrintable(
+							tr( "Graph structure: %1 vertices, %2 edges (%3 duplicate "
+								"includes merged), %4 KiB of names and attributes, "
+								"%5 KiB of adjacency" )
+							.arg( d.vertexCount() ).arg( d.edgeCount() ).arg( d.mergedEdges() )
+							.arg( d.stringBytes() / 1024 ).arg( d.adjacencyBytes() / 1024 )
+			);
+			message = _reportCycles();
+
+			if( _drawnGraph->transitiveReduction() )
+			{
+				const TransitiveReduction& reduction = _drawnGraph->reduction();
+				qDebug() << qPrintable(
+								tr( "Transitive reduction left out %1 of %2 edges in %3 ms" )
+								.arg( reduction.redundantEdges().count() )
+								.arg( d.edgeCount() ).arg( reduction.elapsed() )
+				);
+			}
+		}
+
+		_finishDrawing( message );
+		delete _layoutWatcher;
+		_layoutWatcher = 0;
+	}
+	//-------------------------------------------------------------------------
+	QString MainWindow::_reportCycles()
+	{
+		const DependencyGraph& d = _drawnGraph->dependencies();
+		const CycleFinder& finder = _drawnGraph->cycleFinder();
+		const QList<QVector<DependencyGraph::VertexId> >& cycles = finder.cycles();
+		qDebug() << qPrintable(
+						tr( "Found %1 include cycles in %2 ms" )
+						.arg( cycles.count() ).arg( finder.elapsed() )
 		);
-		//Force toolbar buttons update
-		_onCurrentTabChanged( _ui->tabWidget->currentIndex() );
+
+		//Only the first few files of each cycle are named
+		const int namedFiles = 8;
+		foreach( const QVector<DependencyGraph::VertexId>& cycle, cycles )
+		{
+			QStringList names;
+			for( int i = 0; i < cycle.count() && i < namedFiles; ++i )
+				names.append( d.label( cycle.at( i ) ) );
+
+			if( cycle.count() > namedFiles )
+				names.append( tr( "and %1 more" ).arg( cycle.count() - namedFiles ) );
+
+			qDebug() << qPrintable(
+							tr( "Cycle of %1 files: %2" )
+							.arg( cycle.count() ).arg( names.join( ", " ) )
+			);
+		}
+
+		if( cycles.isEmpty() )
+			return tr( "All done" );
+
+		//The largest cycle comes first; the export lists all of them in full
+		const int shownFiles = 3;
+		const QVector<DependencyGraph::VertexId>& largest = cycles.first();
+		QStringList names;
+		for( int i = 0; i < largest.count() && i < shownFiles; ++i )
+			names.append( d.label( largest.at( i ) ) );
+
+		if( largest.count() > shownFiles )
+			names.append( "..." );
+
+		return tr( "All done, %1 include cycles found; the largest one has %2 files: %3" )
+				.arg( cycles.count() ).arg( largest.count() ).arg( names.join( ", " ) );
+	}
+	//-------------------------------------------------------------------------
+	void MainWindow::_onGraphLayoutCancelled()
+	{
+		//The graph clears itself
+		_progressTimer->stop();
+		_finishDrawing( tr( "Drawing cancelled" ) );
 		delete _layoutWatcher;
 		_layoutWatcher = 0;
 	}
@@ -1002,6 +1591,10 @@ namespace depgraphV
 					tr( "Detected changes on \"%1\"" ).arg( filePath )
 		);
 
+		//A draw is in progress; the change is picked up by the next one
+		if( _isDrawing() )
+			return;
+
 		QStringList l = _project->currentGraph()->model()->filesModel()->checkedFiles();
 		if( !l.contains( filePath ) )
 			return;
@@ -1024,6 +1617,11 @@ namespace depgraphV
 		_onDraw();
 	}
 	//-------------------------------------------------------------------------
+	void MainWindow::_updateProgress()
+	{
+		_progressBar->setValue( Helpers::atomicLoad( _progressCounter ) );
+	}
+	//-------------------------------------------------------------------------
 	QByteArray MainWindow::_postData()
 	{
 		static QByteArray postData;
@@ -58,6 +58,18 @@
 #	include "appconfig.h"
 #endif
 
+#ifndef COMPILATIONDATABASE_H
+#	include "compilationdatabase.h"
+#endif
+
+#ifndef SCANPIPELINE_H
+#	include "scanpipeline.h"
+#endif
+
+#ifndef STRINGINTERNER_H
+#	include "stringinterner.h"
+#endif
+
 namespace depgraphV
 {
 	namespace Ui
@@ -116,12 +128,15 @@ namespace depgraphV
 		void _clearRecentDocs();
 
 		void _onDraw();
+		void _onCancelDraw();
 		void _onClear( bool = true );
 		void _onConfigRestored();
 
 		//Project Menu
 		void _saveAsDot();
 		void _saveAsImage();
+		void _exportRedundantIncludes();
+		void _exportIncludeCycles();
 		void _showProjectInfo();
 
 		//Tabwidget slots
@@ -142,19 +157,59 @@ namespace depgraphV
 
 		void _onRecentDocumentTriggered();
 
+		void _onCompilationDatabaseLoaded();
+		void _onPipelineResultsReady();
+		void _onPipelineFinished();
+		void _onFilesParsed( int, int );
+		void _onFilesParsingFinished();
 		void _onGraphLayoutApplied( bool, const QString& );
+		void _onGraphLayoutCancelled();
 		void _onFileChanged( const QString& );
+		void _updateProgress();
 
 	private:
 		Ui::MainWindow* _ui;
 		Project* _project;
 
 		QProgressBar* _progressBar;
+		QToolButton* _cancelButton;
+		QAction* _actionCancelDraw;
 		AppConfig* _config;
 
 		QNetworkAccessManager* _netManager;
 
+		QFutureWatcher<CompilationDatabase>* _databaseWatcher;
+		ScanPipeline* _scanPipeline;
+		QFutureWatcher<Graph::ParsedFile>* _parseWatcher;
 		QFutureWatcher<void>* _layoutWatcher;
+		Graph* _drawnGraph;
+
+		//Raised by the Cancel action, polled by every drawing stage
+		CancellationToken _cancellation;
+
+		//Progress of the background operations, polled by _progressTimer
+		QAtomicInt _progressCounter;
+		QTimer* _progressTimer;
+		qint64 _bytesScanned;
+		qint64 _bytesSkipped;
+
+		//"Follow includes" mode: files are parsed one include level at a
+		//time, until no new file is found or a limit is reached
+		bool _followIncludes;
+		int _followDepth;
+		int _maxFollowDepth;
+		int _maxFollowedFiles;
+		int _followedFiles;
+		//Paths met while following includes, compared by id in the sets
+		StringInterner _paths;
+		QSet<StringInterner::Id> _visitedFiles;
+		QSet<StringInterner::Id> _discoveredIncludes;
+		QStringList _nextFiles;
+		QSet<StringInterner::Id> _parsedAhead;
+
+		//Device and inode of every folder walked and file parsed, so that
+		//each one is handled once whatever the path leading to it
+		FileIdSet _seenFiles;
 
 		//Dialogs
 		AboutDialog* _aboutDlg;
@@ -174,9 +229,24 @@ namespace depgraphV
 		QMap<QString, QString> _imageFiltersByExt;
 
 		void _doSaveProject( bool saveAs );
-		void _scanFolder( const QFlags<QDir::Filter>& flags, QStringList* filesList, QFileInfo& dirInfo );
-		void _scanFolders() const;
-		void _scanFiles( const QStringList& files ) const;
+		void _scanCompilationDatabase();
+		void _scanFolders();
+		bool _collectTrackedFiles( const QStringList& folders, QStringList* files );
+		FolderWalker _createFolderWalker() const;
+		void _scanFiles( const QStringList& files,
+						 const QStringList& extraIncludePaths = QStringList()
+		);
+		void _prepareParsing( const QStringList& extraIncludePaths = QStringList() );
+		void _parseFiles( const QStringList& absFilePaths );
+		void _handleParsedFile( const Graph::ParsedFile& file );
+		void _markSelectedFile( const Graph::ParsedFile& file );
+		void _followIncludesOf( const Graph::ParsedFile& file );
+		void _finishParsingLevel();
+		void _applyLayout();
+		QString _reportCycles();
+		void _finishDrawing( const QString& statusBarMessage );
+		void _abortDrawing();
+		bool _isDrawing() const;
 		void _doClearGraph() const;
 		void _setActionsAndMenusEnabledOnProjectEvents( bool enabled ) const;
 		void _onProjectOpened( const QString& statusBarMessage );
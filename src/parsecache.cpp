@@ -0,0 +1,522 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * parsecache.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "parsecache.h"
+#include "helpers.h"
+
+namespace depgraphV
+{
+	#define CACHE_LATEST_VER	5
+	#define CACHE_MAGIC			( ( 'C' << 24 ) + ( 'P' << 16 ) + ( 'G' << 8 ) + 'D' )
+
+	static const quint64 PRIME64_1 = Q_UINT64_C( 11400714785074694791 );
+	static const quint64 PRIME64_2 = Q_UINT64_C( 14029467366897019727 );
+	static const quint64 PRIME64_3 = Q_UINT64_C( 1609587929392839161 );
+	static const quint64 PRIME64_4 = Q_UINT64_C( 9650029242287828579 );
+	static const quint64 PRIME64_5 = Q_UINT64_C( 2870177450012600261 );
+
+	static inline quint64 _rotl64( quint64 x, int r )
+	{
+		return ( x << r ) | ( x >> ( 64 - r ) );
+	}
+
+	static inline quint64 _read64( const char* p )
+	{
+		return qFromLittleEndian<quint64>( reinterpret_cast<const uchar*>( p ) );
+	}
+
+	static inline quint32 _read32( const char* p )
+	{
+		return qFromLittleEndian<quint32>( reinterpret_cast<const uchar*>( p ) );
+	}
+
+	static inline quint64 _round( quint64 acc, quint64 input )
+	{
+		acc += input * PRIME64_2;
+		acc = _rotl64( acc, 31 );
+		return acc * PRIME64_1;
+	}
+
+	static inline quint64 _mergeRound( quint64 acc, quint64 val )
+	{
+		acc ^= _round( 0, val );
+		return acc * PRIME64_1 + PRIME64_4;
+	}
+	//-------------------------------------------------------------------------
+	bool ParseCache::FileStamp::operator==( const FileStamp& other ) const
+	{
+		return size == other.size &&
+			   mtime == other.mtime &&
+			   inode == other.inode;
+	}
+	//-------------------------------------------------------------------------
+	bool ParseCache::FileStamp::read( const QString& absFilePath, FileStamp* stamp,
+									  FileIdSet::FileId* id )
+	{
+		Q_ASSERT( stamp );
+#ifdef WIN32
+		Q_UNUSED( id );
+		QFileInfo info( absFilePath );
+		if( !info.exists() )
+			return false;
+
+		stamp->size = info.size();
+		stamp->mtime = info.lastModified().toMSecsSinceEpoch();
+		stamp->inode = 0;
+#else
+		struct stat st;
+		if( ::stat( QFile::encodeName( absFilePath ).constData(), &st ) != 0 )
+			return false;
+
+		stamp->size = st.st_size;
+#	ifdef Q_OS_MAC
+		stamp->mtime = qint64( st.st_mtimespec.tv_sec ) * 1000000000 + st.st_mtimespec.tv_nsec;
+#	else
+		stamp->mtime = qint64( st.st_mtim.tv_sec ) * 1000000000 + st.st_mtim.tv_nsec;
+#	endif
+		stamp->inode = st.st_ino;
+		if( id )
+		{
+			id->device = st.st_dev;
+			id->inode = st.st_ino;
+		}
+#endif
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	ParseCache::ParseCache()
+		: _hits( 0 ),
+		  _misses( 0 ),
+		  _evictions( 0 ),
+		  _reparsesAvoided( 0 ),
+		  _modified( 0 ),
+		  _hashContents( false ),
+		  _session( 0 )
+	{
+	}
+	//-------------------------------------------------------------------------
+	ParseCache::Entry ParseCache::find( const QString& absFilePath,
+										IncludeScanner::Mode mode,
+										const FileStamp& stamp,
+										Entry* outdated )
+	{
+		Shard& s = _shard( absFilePath );
+		QReadLocker locker( &s.lock );
+		Entry entry = s.entries[ mode ].value( absFilePath );
+		if( entry && entry->stamp == stamp )
+		{
+			_hits.ref();
+			_touch( entry );
+			return entry;
+		}
+
+		if( outdated )
+			*outdated = entry;
+
+		_misses.ref();
+		return Entry();
+	}
+	//-------------------------------------------------------------------------
+	ParseCache::Entry ParseCache::insert( const QString& absFilePath,
+										  IncludeScanner::Mode mode,
+										  const FileStamp& stamp,
+										  quint64 hash,
+										  const QStringList& includes )
+	{
+		Shard& s = _shard( absFilePath );
+		QWriteLocker locker( &s.lock );
+		Entry& entry = s.entries[ mode ][ absFilePath ];
+		if( !entry || entry->stamp != stamp )
+		{
+			CachedFile* file = new CachedFile;
+			file->stamp = stamp;
+			file->hash = hash;
+			file->includes = includes;
+			Helpers::atomicStore( file->lastSession, _session );
+			entry = Entry( file );
+			Helpers::atomicStore( _modified, 1 );
+		}
+		else
+			_touch( entry );
+
+		return entry;
+	}
+	//-------------------------------------------------------------------------
+	ParseCache::Entry ParseCache::refresh( const QString& absFilePath,
+										   IncludeScanner::Mode mode,
+										   const FileStamp& stamp,
+										   const Entry& outdated )
+	{
+		Q_ASSERT( outdated );
+		_reparsesAvoided.ref();
+		return insert( absFilePath, mode, stamp, outdated->hash, outdated->includes );
+	}
+	//-------------------------------------------------------------------------
+	quint64 ParseCache::contentHash( const char* data, qint64 size )
+	{
+		//XXH64 with seed 0
+		const char* p = data;
+		const char* end = data + size;
+		quint64 h;
+
+		if( size >= 32 )
+		{
+			const char* limit = end - 32;
+			quint64 v1 = PRIME64_1 + PRIME64_2;
+			quint64 v2 = PRIME64_2;
+			quint64 v3 = 0;
+			quint64 v4 = 0 - PRIME64_1;
+
+			do
+			{
+				v1 = _round( v1, _read64( p ) );
+				v2 = _round( v2, _read64( p + 8 ) );
+				v3 = _round( v3, _read64( p + 16 ) );
+				v4 = _round( v4, _read64( p + 24 ) );
+				p += 32;
+			} while( p <= limit );
+
+			h = _rotl64( v1, 1 ) + _rotl64( v2, 7 ) +
+				_rotl64( v3, 12 ) + _rotl64( v4, 18 );
+			h = _mergeRound( h, v1 );
+			h = _mergeRound( h, v2 );
+			h = _mergeRound( h, v3 );
+			h = _mergeRound( h, v4 );
+		}
+		else
+			h = PRIME64_5;
+
+		h += quint64( size );
+
+		for( ; p + 8 <= end; p += 8 )
+		{
+			h ^= _round( 0, _read64( p ) );
+			h = _rotl64( h, 27 ) * PRIME64_1 + PRIME64_4;
+		}
+
+		if( p + 4 <= end )
+		{
+			h ^= quint64( _read32( p ) ) * PRIME64_1;
+			h = _rotl64( h, 23 ) * PRIME64_2 + PRIME64_3;
+			p += 4;
+		}
+
+		for( ; p < end; ++p )
+		{
+			h ^= quint64( static_cast<uchar>( *p ) ) * PRIME64_5;
+			h = _rotl64( h, 11 ) * PRIME64_1;
+		}
+
+		h ^= h >> 33;
+		h *= PRIME64_2;
+		h ^= h >> 29;
+		h *= PRIME64_3;
+		h ^= h >> 32;
+		return h;
+	}
+	//-------------------------------------------------------------------------
+	void ParseCache::invalidate( const QString& absFilePath )
+	{
+		Shard& s = _shard( absFilePath );
+		QWriteLocker locker( &s.lock );
+		for( int m = 0; m < 2; ++m )
+		{
+			if( s.entries[ m ].remove( absFilePath ) )
+			{
+				_evictions.ref();
+				Helpers::atomicStore( _modified, 1 );
+			}
+		}
+	}
+	//-------------------------------------------------------------------------
+	void ParseCache::clear()
+	{
+		for( int i = 0; i < ShardCount; ++i )
+		{
+			QWriteLocker locker( &_shards[ i ].lock );
+			for( int m = 0; m < 2; ++m )
+				_shards[ i ].entries[ m ].clear();
+		}
+
+		Helpers::atomicStore( _modified, 1 );
+	}
+	//-------------------------------------------------------------------------
+	int ParseCache::count() const
+	{
+		int result = 0;
+		for( int i = 0; i < ShardCount; ++i )
+		{
+			QReadLocker locker( &_shards[ i ].lock );
+			for( int m = 0; m < 2; ++m )
+				result += _shards[ i ].entries[ m ].count();
+		}
+
+		return result;
+	}
+	//-------------------------------------------------------------------------
+	int ParseCache::hits() const
+	{
+		return Helpers::atomicLoad( _hits );
+	}
+	//-------------------------------------------------------------------------
+	int ParseCache::misses() const
+	{
+		return Helpers::atomicLoad( _misses );
+	}
+	//-------------------------------------------------------------------------
+	int ParseCache::evictions() const
+	{
+		return Helpers::atomicLoad( _evictions );
+	}
+	//-------------------------------------------------------------------------
+	int ParseCache::reparsesAvoided() const
+	{
+		return Helpers::atomicLoad( _reparsesAvoided );
+	}
+	//-------------------------------------------------------------------------
+	void ParseCache::resetStatistics()
+	{
+		Helpers::atomicStore( _hits, 0 );
+		Helpers::atomicStore( _misses, 0 );
+		Helpers::atomicStore( _evictions, 0 );
+		Helpers::atomicStore( _reparsesAvoided, 0 );
+	}
+	//-------------------------------------------------------------------------
+	bool ParseCache::load( const QString& fileName )
+	{
+		clear();
+		Helpers::atomicStore( _modified, 0 );
+		_session = 0;
+
+		QFile f( fileName );
+		if( !f.open( QIODevice::ReadOnly ) )
+			return false;
+
+		QByteArray data = qUncompress( f.readAll() );
+		f.close();
+
+		QDataStream stream( data );
+		stream.setVersion( QDataStream::Qt_4_6 );
+		quint32 fileMagic = 0;
+		quint32 version = 0;
+		qint32 savedSession = 0;
+		stream >> fileMagic >> version;
+		if( fileMagic != CACHE_MAGIC || version != CACHE_LATEST_VER )
+			return false;
+
+		stream >> savedSession;
+		_session = savedSession + 1;
+		int dropped = 0;
+
+		//Include names are stored once and referenced by index
+		QStringList names;
+		quint32 entriesCount;
+		stream >> names >> entriesCount;
+
+		for( quint32 e = 0; e < entriesCount && stream.status() == QDataStream::Ok; ++e )
+		{
+			QString path;
+			quint8 mode;
+			FileStamp stamp;
+			quint32 includesCount;
+			quint64 hash;
+			qint32 lastSession;
+			stream >> path >> mode >> stamp.size >> stamp.mtime >> stamp.inode;
+			stream >> hash >> lastSession >> includesCount;
+
+			CachedFile* file = new CachedFile;
+			file->stamp = stamp;
+			file->hash = hash;
+			Helpers::atomicStore( file->lastSession, lastSession );
+			for( quint32 i = 0; i < includesCount; ++i )
+			{
+				quint32 index;
+				stream >> index;
+				if( index < quint32( names.count() ) )
+					file->includes.append( names[ index ] );
+				else
+					stream.setStatus( QDataStream::ReadCorruptData );
+			}
+
+			if( mode > IncludeScanner::Preamble )
+				stream.setStatus( QDataStream::ReadCorruptData );
+
+			if( stream.status() != QDataStream::Ok )
+			{
+				delete file;
+				break;
+			}
+
+			if( _session - lastSession > maxIdleSessions() )
+			{
+				delete file;
+				dropped++;
+				continue;
+			}
+
+			Shard& s = _shard( path );
+			QWriteLocker locker( &s.lock );
+			s.entries[ mode ].insert( path, Entry( file ) );
+		}
+
+		if( stream.status() != QDataStream::Ok )
+		{
+			clear();
+			Helpers::atomicStore( _modified, 0 );
+			_session = 0;
+			return false;
+		}
+
+		//Saving the cache makes the dropped entries go away from the file too
+		_evictions.fetchAndAddOrdered( dropped );
+		Helpers::atomicStore( _modified, dropped ? 1 : 0 );
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	bool ParseCache::save( const QString& fileName )
+	{
+		QMutexLocker saveLocker( &_saveMutex );
+
+		//Changes made while saving are saved the next time
+		if( !_modified.fetchAndStoreOrdered( 0 ) )
+			return true;
+
+		QByteArray data;
+		QDataStream stream( &data, QIODevice::WriteOnly );
+		stream.setVersion( QDataStream::Qt_4_6 );
+		stream << quint32( CACHE_MAGIC ) << quint32( CACHE_LATEST_VER ) << qint32( _session );
+
+		QStringList names;
+		QHash<QString, quint32> nameIndexes;
+		QByteArray entriesData;
+		QDataStream entriesStream( &entriesData, QIODevice::WriteOnly );
+		entriesStream.setVersion( QDataStream::Qt_4_6 );
+		quint32 entriesCount = 0;
+
+		for( int s = 0; s < ShardCount; ++s )
+		{
+			QReadLocker locker( &_shards[ s ].lock );
+			for( quint8 m = 0; m < 2; ++m )
+			{
+				QHash<QString, Entry>::const_iterator it = _shards[ s ].entries[ m ].constBegin();
+				for( ; it != _shards[ s ].entries[ m ].constEnd(); ++it )
+				{
+					const CachedFile& file = *it.value();
+					entriesStream << it.key() << m << file.stamp.size
+								  << file.stamp.mtime << file.stamp.inode;
+					entriesStream << file.hash << qint32( Helpers::atomicLoad( file.lastSession ) )
+								  << quint32( file.includes.count() );
+					foreach( QString inc, file.includes )
+					{
+						if( !nameIndexes.contains( inc ) )
+						{
+							nameIndexes.insert( inc, names.count() );
+							names.append( inc );
+						}
+
+						entriesStream << nameIndexes[ inc ];
+					}
+
+					entriesCount++;
+				}
+			}
+		}
+
+		stream << names << entriesCount;
+		stream.writeRawData( entriesData.constData(), entriesData.size() );
+
+		QDir().mkpath( QFileInfo( fileName ).absolutePath() );
+
+		//Write next to the destination, then move the file over it
+		QString tmpFileName = QString( "%1.%2.tmp" )
+							  .arg( fileName ).arg( QCoreApplication::applicationPid() );
+		QFile f( tmpFileName );
+		if( !f.open( QIODevice::WriteOnly ) )
+		{
+			Helpers::atomicStore( _modified, 1 );
+			return false;
+		}
+
+		QByteArray compressedData = qCompress( data );
+		bool written = f.write( compressedData ) == compressedData.size();
+		f.close();
+
+#ifdef WIN32
+		written = written && MoveFileExW(
+					  reinterpret_cast<const wchar_t*>( tmpFileName.utf16() ),
+					  reinterpret_cast<const wchar_t*>( fileName.utf16() ),
+					  MOVEFILE_REPLACE_EXISTING
+		);
+#else
+		written = written && ::rename( QFile::encodeName( tmpFileName ).constData(),
+									   QFile::encodeName( fileName ).constData() ) == 0;
+#endif
+		if( !written )
+		{
+			QFile::remove( tmpFileName );
+			Helpers::atomicStore( _modified, 1 );
+			return false;
+		}
+
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	QString ParseCache::defaultFileName()
+	{
+#if( QT_VERSION >= QT_VERSION_CHECK( 5, 0, 0 ) )
+		QString folder = QStandardPaths::writableLocation( QStandardPaths::CacheLocation );
+#else
+		QString folder = QDesktopServices::storageLocation( QDesktopServices::CacheLocation );
+#endif
+		return QDir( folder ).filePath( "parsecache.bin" );
+	}
+	//-------------------------------------------------------------------------
+	ParseCache::Shard& ParseCache::_shard( const QString& absFilePath )
+	{
+		return _shards[ qHash( absFilePath ) % ShardCount ];
+	}
+	//-------------------------------------------------------------------------
+	void ParseCache::_touch( const Entry& entry )
+	{
+		//Only the first use in a session is written, and saved
+		if( Helpers::atomicLoad( entry->lastSession ) != _session )
+		{
+			Helpers::atomicStore( entry->lastSession, _session );
+			Helpers::atomicStore( _modified, 1 );
+		}
+	}
+}
@@ -0,0 +1,254 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * parsecache.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+#ifndef INCLUDESCANNER_H
+#	include "includescanner.h"
+#endif
+
+#ifndef FILEIDSET_H
+#	include "fileidset.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The ParseCache class stores the includes found in each parsed
+	 * file, so that redrawing a graph does not read the same files again.
+	 *
+	 * Entries are kept separately for each IncludeScanner::Mode and are
+	 * spread over a fixed number of shards, each one guarded by its own
+	 * read-write lock; lookups from different threads only contend when
+	 * they hit the same shard while it is being written.
+	 *
+	 * Each entry remembers the FileStamp of the file it was parsed from and
+	 * is only returned while the file still has that stamp, so the cache
+	 * can be saved to disk and trusted again by the next session. When
+	 * hashContents() is enabled, entries also store a hash of the file
+	 * content, so that a file whose stamp changed but whose content did not
+	 * (after a checkout, for instance) keeps its includes without a re-scan.
+	 *
+	 * Entries are immutable and reference counted: an entry returned by
+	 * find() or insert() stays valid even if it is invalidated meanwhile.
+	 *
+	 * Every load() starts a new session. Entries remember the last session
+	 * they were found or stored in, and those left unused for
+	 * maxIdleSessions() sessions (deleted or renamed files, projects not
+	 * drawn anymore) are dropped when the cache is loaded, so that it does
+	 * not grow forever.
+	 */
+	class ParseCache
+	{
+	public:
+		/**
+		 * @brief The FileStamp struct identifies a version of a file by its
+		 * size, modification time and inode, as reported by a single stat.
+		 */
+		struct FileStamp
+		{
+			qint64 size;
+			qint64 mtime;
+			quint64 inode;
+
+			bool operator==( const FileStamp& other ) const;
+			bool operator!=( const FileStamp& other ) const { return !( *this == other ); }
+
+			/**
+			 * @brief Read the stamp of the file at \a absFilePath.
+			 * @param id If not null, it receives the full device and inode
+			 * numbers from the same stat (left untouched on Windows).
+			 * @return False if the file cannot be stat'ed.
+			 */
+			static bool read( const QString& absFilePath, FileStamp* stamp,
+							  FileIdSet::FileId* id = 0 );
+		};
+
+		struct CachedFile
+		{
+			FileStamp stamp;
+			//0 when the content has not been hashed
+			quint64 hash;
+			QStringList includes;
+			//Last session the entry has been used in
+			mutable QAtomicInt lastSession;
+		};
+
+		typedef QSharedPointer<const CachedFile> Entry;
+
+		ParseCache();
+
+		/**
+		 * @brief Return the entry of the file at \a absFilePath parsed with
+		 * \a mode, or a null entry on cache miss or if the entry does not
+		 * match \a stamp anymore.
+		 * @param outdated If not null, it receives the entry which does not
+		 * match \a stamp anymore, if any.
+		 */
+		Entry find( const QString& absFilePath, IncludeScanner::Mode mode,
+					const FileStamp& stamp, Entry* outdated = 0
+		);
+
+		/**
+		 * @brief Store \a includes as the entry of the file at \a absFilePath
+		 * parsed with \a mode when it had \a stamp and \a hash.
+		 * @return The stored entry; if another thread stored the same version
+		 * of the file first, its entry is returned instead.
+		 */
+		Entry insert( const QString& absFilePath, IncludeScanner::Mode mode,
+					  const FileStamp& stamp, quint64 hash,
+					  const QStringList& includes
+		);
+
+		/**
+		 * @brief Store the includes of \a outdated as the entry of the file
+		 * at \a absFilePath, whose content has been found unchanged even
+		 * though its stamp is now \a stamp.
+		 */
+		Entry refresh( const QString& absFilePath, IncludeScanner::Mode mode,
+					   const FileStamp& stamp, const Entry& outdated
+		);
+
+		/**
+		 * @brief Return true if the content of parsed files has to be hashed.
+		 */
+		bool hashContents() const { return _hashContents; }
+
+		/**
+		 * @brief Enable or disable content hashing.
+		 * @remarks Not thread safe; change it only while nothing is parsed.
+		 */
+		void setHashContents( bool value ) { _hashContents = value; }
+
+		/**
+		 * @brief Return the 64-bit hash (XXH64) of \a size bytes at \a data.
+		 */
+		static quint64 contentHash( const char* data, qint64 size );
+
+		/**
+		 * @brief Drop every entry of the file at \a absFilePath.
+		 */
+		void invalidate( const QString& absFilePath );
+
+		/**
+		 * @brief Drop every entry.
+		 */
+		void clear();
+
+		/**
+		 * @brief Return the number of stored entries.
+		 */
+		int count() const;
+
+		int hits() const;
+		int misses() const;
+		int evictions() const;
+
+		/**
+		 * @brief Return how many files kept their includes because their
+		 * content hash did not change, although their stamp did.
+		 */
+		int reparsesAvoided() const;
+		void resetStatistics();
+
+		/**
+		 * @brief Replace the cache content with the one saved in \a fileName.
+		 * @return False if the file is missing, corrupted or has been written
+		 * by an unsupported version; the cache is left empty in that case.
+		 */
+		bool load( const QString& fileName = defaultFileName() );
+
+		/**
+		 * @brief Save the cache content to \a fileName, if it has changed
+		 * since the last load() or save().
+		 * @remarks The file is replaced atomically (where the platform allows
+		 * it), so other running instances never read a partial cache. This
+		 * method is thread safe: it can run in the background while files
+		 * are parsed, and concurrent saves are serialized.
+		 */
+		bool save( const QString& fileName = defaultFileName() );
+
+		/**
+		 * @brief Return after how many sessions without being used an entry
+		 * is dropped.
+		 */
+		static int maxIdleSessions() { return 8; }
+
+		/**
+		 * @brief Return the path of the cache file inside the user cache
+		 * directory (XDG_CACHE_HOME on Linux).
+		 */
+		static QString defaultFileName();
+
+	private:
+		enum { ShardCount = 16 };
+
+		struct Shard
+		{
+			mutable QReadWriteLock lock;
+			//By IncludeScanner::Mode
+			QHash<QString, Entry> entries[ 2 ];
+		};
+
+		Shard _shards[ ShardCount ];
+
+		QAtomicInt _hits;
+		QAtomicInt _misses;
+		QAtomicInt _evictions;
+		QAtomicInt _reparsesAvoided;
+		QAtomicInt _modified;
+		bool _hashContents;
+		int _session;
+		QMutex _saveMutex;
+
+		Shard& _shard( const QString& absFilePath );
+		void _touch( const Entry& entry );
+
+		Q_DISABLE_COPY( ParseCache )
+	};
+}
+
+#endif // PARSECACHE_H
@@ -42,7 +42,7 @@ namespace depgraphV
 {
 	const QString Project::defaultExtension = ".dProj";
 
-	#define LATEST_VER	1
+	#define LATEST_VER	2
 	#define MAGIC		( ( 'A' << 24 ) + ( 'V' << 16 ) + ( 'G' << 8 ) + 'G' )
 
 	//-------------------------------------------------------------------------
@@ -76,6 +76,16 @@ namespace depgraphV
 			<< "scanByFolders"
 			<< "scanRecursively"
 			<< "includeHiddenFolders"
+			<< "excludePatterns"
+			<< "honorGitignore"
+			<< "useGitIndex"
+			<< "preambleOnly"
+			<< "followIncludes"
+			<< "followIncludesDepth"
+			<< "followIncludesMaxFiles"
+			<< "includePaths"
+			<< "useCompilationDatabase"
+			<< "compilationDatabase"
 
 			//Header Filters
 			<< "hdr_parseEnabled"
@@ -91,6 +101,7 @@ namespace depgraphV
 
 			//Graph settings
 			<< "layoutAlgorithm"
+			<< "transitiveReduction"
 			<< "highQualityAA"
 			<< "rendererType"
 
@@ -107,6 +118,8 @@ namespace depgraphV
 		for( int i = 0; i < f.size(); i++ )
 			_fields.insert( f[ i ], i );
 
+		_fieldNames = f;
+
 		_model->setHorizontalHeaderLabels( f );
 
 		connect( _delegate, SIGNAL( editingStarted() ),
@@ -332,6 +345,10 @@ namespace depgraphV
 	//-------------------------------------------------------------------------
 	void Project::watchFile( const QString& filePath )
 	{
+		if( _watchedFiles.contains( filePath ) )
+			return;
+
+		_watchedFiles.insert( filePath );
 		_watcher->addPath( filePath );
 	}
 	//-------------------------------------------------------------------------
@@ -359,11 +376,14 @@ namespace depgraphV
 		}
 
 		stream >> _version;
-		if( _version < LATEST_VER )
-		{
-			//TODO
-			//Warn about old file format and/or upgrade to latest version
-		}
+
+		//Since version 2, field names are stored along with the records,
+		//so that fields can be added without breaking older project files.
+		QStringList fileFields;
+		if( _version < 2 )
+			fileFields = _v1FieldNames();
+		else
+			stream >> fileFields;
 
 		int rows;
 		stream >> rows;
@@ -371,7 +391,7 @@ namespace depgraphV
 		_delegate->disableConnections( true );
 		for( int r = 0; r < rows; r++ )
 		{
-			for( int c = 0; c < _model->columnCount(); c++ )
+			for( int c = 0; c < fileFields.count(); c++ )
 			{
 				bool skip;
 				stream >> skip;
@@ -380,10 +400,21 @@ namespace depgraphV
 
 				QStandardItem* i = new QStandardItem();
 				i->read( stream );
-				if( c == 0 )
+
+				int idx = fieldIndex( fileFields[ c ] );
+				if( idx == -1 )
+					delete i;
+				else if( idx == 0 )
 					_newGraph( i );
 				else
-					_model->setItem( r, c, i );
+					_model->setItem( r, idx, i );
+			}
+
+			//Fields missing from the file get their default values
+			foreach( int k, _defaultValues.keys() )
+			{
+				if( !_model->item( r, k ) )
+					setValue( QVariant(), r, k );
 			}
 		}
 		_delegate->disableConnections( false );
@@ -422,10 +453,12 @@ namespace depgraphV
 		QFile f( _fullPath );
 		if( f.open( QIODevice::WriteOnly ) )
 		{
+			_version = LATEST_VER;
 			QByteArray data;
 			QDataStream stream( &data, QIODevice::WriteOnly );
 			stream << MAGIC;
 			stream << _version;
+			stream << _fieldNames;
 			stream << _model->rowCount();
 
 			for( int r = 0; r < _model->rowCount(); r++ )
@@ -513,10 +546,31 @@ namespace depgraphV
 	//-------------------------------------------------------------------------
 	void Project::_onFileChanged( const QString& filePath )
 	{
+		//The watcher may drop a file which has been replaced or removed;
+		//it is watched again as soon as it is parsed again
+		_watchedFiles.remove( filePath );
+		_watcher->removePath( filePath );
 		Graph::notifyFileHasChanged( filePath );
 		emit fileHasChanged( filePath );
 	}
 	//-------------------------------------------------------------------------
+	QStringList Project::_v1FieldNames()
+	{
+		QStringList f;
+		f	<< "name" << "selectedFolders" << "scanByFolders"
+			<< "scanRecursively" << "includeHiddenFolders"
+			<< "hdr_parseEnabled" << "hdr_standardFiltersEnabled"
+			<< "hdr_currentStandardFilter" << "hdr_customFilters"
+			<< "src_parseEnabled" << "src_standardFiltersEnabled"
+			<< "src_currentStandardFilter" << "src_customFilters"
+			<< "layoutAlgorithm" << "highQualityAA" << "rendererType"
+			<< "graphModel" << "graph_splines" << "graph_nodesep"
+			<< "vertex_shape" << "vertex_style" << "edge_minlen"
+			<< "edge_style";
+
+		return f;
+	}
+	//-------------------------------------------------------------------------
 	void Project::_updateProjectProperties()
 	{
 		if( !_fullPath.isEmpty() )
@@ -195,6 +195,7 @@ namespace depgraphV
 		/**
 		 * @brief Start keeping track of any change on file in \a filePath.
 		 * @param The path to the file being watched.
+		 * @remarks Watching an already watched file does nothing.
 		 */
 		void watchFile( const QString& filePath );
 
@@ -228,6 +229,12 @@ namespace depgraphV
 		void _triggerUnsubmittedChanges( bool );
 		void _newGraph( QStandardItem* = 0 );
 
+		/**
+		 * @brief Return the fields stored by version 1 project files, which
+		 * don't save field names.
+		 */
+		static QStringList _v1FieldNames();
+
 		QString _name;
 		QString _path;
 		QString _fullPath;
@@ -235,6 +242,7 @@ namespace depgraphV
 		unsigned short _version;
 
 		QHash<QString, int> _fields;
+		QStringList _fieldNames;
 		QHash<int, QVariant> _defaultValues;
 
 		QStandardItemModel* _model;
@@ -248,6 +256,7 @@ namespace depgraphV
 		bool _modified;
 
 		QFileSystemWatcher* _watcher;
+		QSet<QString> _watchedFiles;
 	};
 }
 
@@ -0,0 +1,444 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * scanbenchmark.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "scanbenchmark.h"
+#include "includescanner.h"
+#include "batchreader.h"
+
+namespace depgraphV
+{
+	int ScanBenchmark::run( const QString& folder )
+	{
+		QStringList files = _collectFiles( folder );
+		if( files.isEmpty() )
+		{
+			printf( "No C/C++ files found in \"%s\".\n", qPrintable( folder ) );
+			return 1;
+		}
+
+		printf( "Read paths (warm page cache)\n" );
+		_warmPageCache( files );
+		_runReadPath( files, FileReader::Mapped, "mmap" );
+		_runReadPath( files, FileReader::Buffered, "read" );
+		_runReadPath( files, FileReader::Automatic, "automatic" );
+		printf( "\nScanners (in-memory files)\n" );
+
+		//Files are loaded up-front, so that only scanning is measured
+		QList<QByteArray> contents;
+		qint64 totalBytes = 0;
+		foreach( QString path, files )
+		{
+			QFile f( path );
+			if( !f.open( QIODevice::ReadOnly ) )
+				continue;
+
+			contents << f.readAll();
+			totalBytes += contents.last().size();
+		}
+
+		printf( "%d files, %.2f MiB\n\n", contents.count(),
+				totalBytes / ( 1024.0 * 1024.0 )
+		);
+
+		QElapsedTimer timer;
+		QList<QStringList> legacyResults;
+		timer.start();
+		foreach( const QByteArray& c, contents )
+			legacyResults << _legacyScan( c );
+		qint64 legacyTime = timer.nsecsElapsed();
+
+		QList<QStringList> results;
+		IncludeScanner scanner;
+		timer.restart();
+		foreach( const QByteArray& c, contents )
+			results << scanner.scan( c );
+		qint64 scannerTime = timer.nsecsElapsed();
+
+		int mismatches = 0;
+		for( int i = 0; i < results.count(); ++i )
+		{
+			if( results[ i ] != legacyResults[ i ] )
+				mismatches++;
+		}
+
+		_printResult( "QRegExp pipeline", totalBytes, legacyTime );
+		_printResult( "IncludeScanner", totalBytes, scannerTime );
+		printf( "\nSpeedup: %.1fx\n",
+				legacyTime / static_cast<double>( qMax<qint64>( scannerTime, 1 ) )
+		);
+		printf( "Files with different include lists: %d\n", mismatches );
+
+		_runKernels( contents, totalBytes );
+
+		return 0;
+	}
+	//-------------------------------------------------------------------------
+	int ScanBenchmark::runColdCache( const QString& folder )
+	{
+		QStringList files = _collectFiles( folder );
+		if( files.isEmpty() )
+		{
+			printf( "No C/C++ files found in \"%s\".\n", qPrintable( folder ) );
+			return 1;
+		}
+
+		int threads = QThread::idealThreadCount();
+		printf( "%d files, %d threads\n\n", files.count(), threads );
+
+		printf( "Thread pool (%s)\n", _dropCaches( files ) );
+		QElapsedTimer timer;
+		timer.start();
+		QList<qint64> sizes = QtConcurrent::blockingMapped<QList<qint64> >(
+								  files, &ScanBenchmark::_readAndScan
+		);
+		qint64 elapsed = timer.nsecsElapsed();
+		qint64 bytes = 0;
+		foreach( qint64 size, sizes )
+			bytes += qMax<qint64>( size, 0 );
+
+		_printResult( "one file at a time", bytes, elapsed );
+
+		if( !BatchReader::isSupported() )
+		{
+			printf( "\nio_uring is not available on this system\n" );
+			return 0;
+		}
+
+		const int queueDepths[] = { 8, 32, 128 };
+		for( unsigned int i = 0; i < sizeof( queueDepths ) / sizeof( queueDepths[ 0 ] ); ++i )
+		{
+			printf( "\nio_uring, %d files in flight per thread (%s)\n",
+					queueDepths[ i ], _dropCaches( files )
+			);
+
+			QAtomicInt next( 0 );
+			QList<QFuture<qint64> > workers;
+			timer.restart();
+			for( int t = 0; t < threads; ++t )
+			{
+				workers << QtConcurrent::run( &ScanBenchmark::_readAndScanBatched,
+											  &files, &next, queueDepths[ i ]
+				);
+			}
+
+			bytes = 0;
+			foreach( QFuture<qint64> worker, workers )
+				bytes += qMax<qint64>( worker.result(), 0 );
+
+			_printResult( "batched", bytes, timer.nsecsElapsed() );
+		}
+
+		return 0;
+	}
+	//-------------------------------------------------------------------------
+	QStringList ScanBenchmark::_collectFiles( const QString& folder )
+	{
+		QStringList nameFilters;
+		nameFilters << "*.h" << "*.hh" << "*.hpp" << "*.hxx" << "*.inl"
+					<< "*.c" << "*.cc" << "*.cpp" << "*.cxx";
+
+		QStringList files;
+		QDirIterator it( folder, nameFilters, QDir::Files,
+						 QDirIterator::Subdirectories
+		);
+		while( it.hasNext() )
+			files << it.next();
+
+		return files;
+	}
+	//-------------------------------------------------------------------------
+	void ScanBenchmark::_warmPageCache( const QStringList& files )
+	{
+		//FileReader is not used here: its per-thread buffer would be
+		//inherited by the processes measuring the read paths
+		char chunk[ 64 * 1024 ];
+		foreach( QString path, files )
+		{
+			QFile f( path );
+			if( !f.open( QIODevice::ReadOnly | QIODevice::Unbuffered ) )
+				continue;
+
+			while( f.read( chunk, sizeof( chunk ) ) > 0 )
+				;
+		}
+	}
+	//-------------------------------------------------------------------------
+	void ScanBenchmark::_runReadPath( const QStringList& files,
+									  FileReader::ReadPath path,
+									  const char* name )
+	{
+#ifdef Q_OS_LINUX
+		//Each path is measured in its own process, so that its peak memory
+		//is not hidden by the one reached by the paths measured before
+		fflush( stdout );
+		pid_t pid = fork();
+		if( pid < 0 )
+		{
+			printf( "%-20s cannot be measured: %s\n", name, strerror( errno ) );
+			return;
+		}
+
+		if( pid > 0 )
+		{
+			waitpid( pid, 0, 0 );
+			return;
+		}
+
+		//The child starts with the resident memory of its parent, which
+		//is also where its high-water mark starts from
+		long baseline = _residentKiB();
+#endif
+
+		FileReader reader;
+		IncludeScanner scanner;
+		qint64 bytes = 0;
+		QElapsedTimer timer;
+		timer.start();
+		foreach( QString f, files )
+		{
+			if( !reader.open( f, path ) )
+				continue;
+
+			scanner.scan( reader.data(), reader.size() );
+			bytes += reader.size();
+		}
+		reader.close();
+		_printResult( name, bytes, timer.nsecsElapsed() );
+
+#ifdef Q_OS_LINUX
+		struct rusage usage;
+		getrusage( RUSAGE_SELF, &usage );
+		printf( "%-20s page faults: %ld minor, %ld major; peak RSS: +%ld KiB\n",
+				"", usage.ru_minflt, usage.ru_majflt,
+				qMax( usage.ru_maxrss - baseline, 0L )
+		);
+		fflush( stdout );
+		_exit( 0 );
+#endif
+	}
+	//-------------------------------------------------------------------------
+	long ScanBenchmark::_residentKiB()
+	{
+#ifdef Q_OS_LINUX
+		FILE* statm = fopen( "/proc/self/statm", "r" );
+		if( !statm )
+			return 0;
+
+		long size = 0;
+		long resident = 0;
+		if( fscanf( statm, "%ld %ld", &size, &resident ) != 2 )
+			resident = 0;
+
+		fclose( statm );
+		return resident * ( sysconf( _SC_PAGESIZE ) / 1024 );
+#else
+		return 0;
+#endif
+	}
+	//-------------------------------------------------------------------------
+	void ScanBenchmark::_runKernels( const QList<QByteArray>& contents,
+									 qint64 totalBytes )
+	{
+		printf( "\nSkip kernels\n" );
+		QByteArray synthetic = _syntheticInput();
+		IncludeScanner::Kernel defaultKernel = IncludeScanner::kernel();
+		IncludeScanner::Kernel kernels[] =
+		{
+			IncludeScanner::Scalar,
+			IncludeScanner::SSE2,
+			IncludeScanner::AVX2
+		};
+
+		for( unsigned int i = 0; i < sizeof( kernels ) / sizeof( kernels[ 0 ] ); ++i )
+		{
+			QString name = IncludeScanner::kernelName( kernels[ i ] );
+			if( !IncludeScanner::setKernel( kernels[ i ] ) )
+			{
+				printf( "%-20s not supported\n", qPrintable( name ) );
+				continue;
+			}
+
+			IncludeScanner scanner;
+			QElapsedTimer timer;
+			timer.start();
+			scanner.scan( synthetic );
+			_printResult( qPrintable( name + " (synthetic)" ), synthetic.size(),
+						  timer.nsecsElapsed()
+			);
+
+			timer.restart();
+			foreach( const QByteArray& c, contents )
+				scanner.scan( c );
+			_printResult( qPrintable( name + " (real)" ), totalBytes,
+						  timer.nsecsElapsed()
+			);
+		}
+
+		IncludeScanner::setKernel( defaultKernel );
+		printf( "Default kernel: %s\n", IncludeScanner::kernelName( defaultKernel ) );
+	}
+	//-------------------------------------------------------------------------
+	QByteArray ScanBenchmark::_syntheticInput()
+	{
+		QByteArray data;
+		data.reserve( 64 * 1024 * 1024 );
+		data += "#include <vector>\n#include \"synthetic.h\"\n\n";
+
+		for( int i = 0; data.size() < 64 * 1024 * 1024; ++i )
+		{
+			data += "\tconst unsigned int value" + QByteArray::number( i ) +
+					" = compute( previousValue, 0x7f3a ) * factor + offset;\n";
+
+			if( i % 64 == 0 )
+				data += "\t// A short comment line\n";
+		}
+
+		return data;
+	}
+	//-------------------------------------------------------------------------
+	QStringList ScanBenchmark::_legacyScan( const QByteArray& data )
+	{
+		QStringList includes;
+		QString fileContent = QString::fromUtf8( data.constData(), data.size() );
+
+		QString commentReg( "(//[^\\r\\n]*)|(/\\*([^*]"
+							"|[\\r\\n]|(\\*+([^*/]|[\\r\\n])))*\\*+/)"
+		);
+		fileContent.remove( QRegExp( commentReg ) );
+
+		QRegExp rExp( "#\\s*include\\s*((<[^>]+>)|(\"[^\"]+\"))" );
+		int pos = 0;
+
+		while( ( pos = rExp.indexIn( fileContent, pos ) ) != -1 )
+		{
+			//Delimiters are kept, as IncludeScanner does
+			includes << rExp.cap( 1 );
+			pos += rExp.matchedLength();
+		}
+
+		return includes;
+	}
+	//-------------------------------------------------------------------------
+	const char* ScanBenchmark::_dropCaches( const QStringList& files )
+	{
+#ifdef Q_OS_LINUX
+		::sync();
+		QFile dropCaches( "/proc/sys/vm/drop_caches" );
+		if( dropCaches.open( QIODevice::WriteOnly ) && dropCaches.write( "3\n" ) == 2 )
+			return "page cache dropped";
+
+		//Not root: the data of the files can still be evicted one by one,
+		//but their inodes and directory entries stay cached
+		foreach( QString path, files )
+		{
+			int fd = ::open( QFile::encodeName( path ).constData(), O_RDONLY | O_CLOEXEC );
+			if( fd < 0 )
+				continue;
+
+			posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+			::close( fd );
+		}
+
+		return "file data evicted, metadata still cached; run as root to drop everything";
+#else
+		Q_UNUSED( files );
+		return "warm cache, dropping it is not supported on this platform";
+#endif
+	}
+	//-------------------------------------------------------------------------
+	qint64 ScanBenchmark::_readAndScan( const QString& path )
+	{
+		ParseCache::FileStamp stamp;
+		FileReader reader;
+		if( !ParseCache::FileStamp::read( path, &stamp ) || !reader.open( path ) )
+			return -1;
+
+		IncludeScanner scanner;
+		scanner.scan( reader.data(), reader.size() );
+		return reader.size();
+	}
+	//-------------------------------------------------------------------------
+	qint64 ScanBenchmark::_readAndScanBatched( const QStringList* files,
+											   QAtomicInt* next, int queueDepth )
+	{
+		BatchReader reader( queueDepth );
+		if( !reader.isValid() )
+			return -1;
+
+		IncludeScanner scanner;
+		qint64 bytes = 0;
+		bool ringWorked = reader.read( [ files, next ]( QString* path, bool ) -> bool
+		{
+			int index = next->fetchAndAddOrdered( 1 );
+			if( index >= files->count() )
+				return false;
+
+			*path = files->at( index );
+			return true;
+		},
+		[]( const QString&, const ParseCache::FileStamp& ) { return true; },
+		[ &scanner, &bytes ]( const QString&, const ParseCache::FileStamp&,
+							  const char* data, qint64 size )
+		{
+			if( !data )
+				return;
+
+			scanner.scan( data, size );
+			bytes += size;
+		} );
+
+		//Files left when the ring fails are read the usual way
+		if( !ringWorked )
+		{
+			for( int index = next->fetchAndAddOrdered( 1 ); index < files->count();
+				 index = next->fetchAndAddOrdered( 1 ) )
+			{
+				bytes += qMax<qint64>( _readAndScan( files->at( index ) ), 0 );
+			}
+		}
+
+		return bytes;
+	}
+	//-------------------------------------------------------------------------
+	void ScanBenchmark::_printResult( const char* name, qint64 bytes, qint64 nsecs )
+	{
+		double secs = qMax<qint64>( nsecs, 1 ) / 1e9;
+		printf( "%-20s %10.2f ms %10.2f MiB/s\n", name, secs * 1000.0,
+				bytes / ( 1024.0 * 1024.0 ) / secs
+		);
+	}
+} // end of depgraphV namespace
@@ -0,0 +1,149 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * scanbenchmark.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef SCANBENCHMARK_H
+#define SCANBENCHMARK_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef FILEREADER_H
+#	include "filereader.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The ScanBenchmark class measures the include scanning throughput
+	 * on a real source tree. It is run from the command line (see the
+	 * \a --benchmark option) and prints its results on the standard output.
+	 */
+	class ScanBenchmark
+	{
+	public:
+		/**
+		 * @brief Run the benchmark over every C/C++ file found in \a folder
+		 * and its subfolders.
+		 * @return The application exit code.
+		 */
+		static int run( const QString& folder );
+
+		/**
+		 * @brief Compare reading every C/C++ file in \a folder on the thread
+		 * pool, one file at a time per thread, with io_uring batches of a few
+		 * queue depths, dropping the page cache before each run.
+		 * @return The application exit code.
+		 */
+		static int runColdCache( const QString& folder );
+
+	private:
+		ScanBenchmark(){}
+		~ScanBenchmark(){}
+
+		static QStringList _collectFiles( const QString& folder );
+
+		/**
+		 * @brief Read every file in \a files once, so that they are in the
+		 * page cache before the read paths are measured.
+		 */
+		static void _warmPageCache( const QStringList& files );
+
+		/**
+		 * @brief Read and scan every file in \a files through \a path,
+		 * reporting throughput, page faults and the growth of the resident
+		 * memory. On Linux, the measure runs in a child process.
+		 */
+		static void _runReadPath( const QStringList& files,
+								  FileReader::ReadPath path,
+								  const char* name
+		);
+
+		/**
+		 * @brief Return the resident memory of this process in KiB, or 0
+		 * when unknown.
+		 */
+		static long _residentKiB();
+
+		/**
+		 * @brief The comment-stripping QRegExp pipeline used before
+		 * IncludeScanner was introduced, kept as the reference.
+		 */
+		static QStringList _legacyScan( const QByteArray& data );
+
+		/**
+		 * @brief Compare the IncludeScanner kernels supported by the running
+		 * CPU on a synthetic input and on \a contents.
+		 */
+		static void _runKernels( const QList<QByteArray>& contents,
+								 qint64 totalBytes
+		);
+
+		/**
+		 * @brief Return a generated source file made of ordinary statements,
+		 * with a few includes and comments.
+		 */
+		static QByteArray _syntheticInput();
+
+		/**
+		 * @brief Evict \a files from the page cache: the whole cache when
+		 * allowed to (root only), or just the data of \a files otherwise.
+		 * @return A description of what has been dropped.
+		 */
+		static const char* _dropCaches( const QStringList& files );
+
+		/**
+		 * @brief Stat, read and scan the file at \a path, the way parsers
+		 * on the thread pool do.
+		 * @return The number of bytes read, or -1 on error.
+		 */
+		static qint64 _readAndScan( const QString& path );
+
+		/**
+		 * @brief Read and scan the files of \a files not taken yet by other
+		 * workers (\a next is the first one) through an io_uring.
+		 * @return The number of bytes read, or -1 if io_uring is unavailable.
+		 */
+		static qint64 _readAndScanBatched( const QStringList* files,
+										   QAtomicInt* next, int queueDepth
+		);
+
+		static void _printResult( const char* name, qint64 bytes, qint64 nsecs );
+	};
+}
+
+#endif // SCANBENCHMARK_H
@@ -88,6 +88,24 @@ namespace depgraphV
 		_updateSelectionCount();
 	}
 	//-------------------------------------------------------------------------
+	void ScanModePage::_browseCompilationDatabase()
+	{
+		QString fileName = QFileDialog::getOpenFileName(
+							   this,
+							   tr( "Select compilation database" ),
+							   _ui->compilationDatabaseEdit->text(),
+							   tr( "Compilation databases (compile_commands.json);;"
+								   "JSON files (*.json);;All files (*)" )
+		);
+
+		if( fileName.isEmpty() )
+			return;
+
+		//insert() (unlike setText()) notifies the project about the change
+		_ui->compilationDatabaseEdit->selectAll();
+		_ui->compilationDatabaseEdit->insert( QDir::toNativeSeparators( fileName ) );
+	}
+	//-------------------------------------------------------------------------
 	void ScanModePage::_updateSelectionCount()
 	{
 		Project* p = Singleton<Project>::instancePtr();
@@ -107,5 +125,15 @@ namespace depgraphV
 		p->addMapping( radios, "scanByFolders" );
 		p->addMapping( _ui->recursiveScanCheckBox, "scanRecursively" );
 		p->addMapping( _ui->hiddenFoldersCheckbox, "includeHiddenFolders" );
+		p->addMapping( _ui->excludePatternsEdit, "excludePatterns", "", "" );
+		p->addMapping( _ui->honorGitignoreCheckBox, "honorGitignore", "", false );
+		p->addMapping( _ui->useGitIndexCheckBox, "useGitIndex", "", false );
+		p->addMapping( _ui->preambleOnlyCheckBox, "preambleOnly", "", false );
+		p->addMapping( _ui->followIncludesCheckBox, "followIncludes", "", false );
+		p->addMapping( _ui->followIncludesDepthSpinBox, "followIncludesDepth", "", 8 );
+		p->addMapping( _ui->followIncludesMaxFilesSpinBox, "followIncludesMaxFiles", "", 5000 );
+		p->addMapping( _ui->includePathsEdit, "includePaths", "", "" );
+		p->addMapping( _ui->useCompilationDatabaseCheckBox, "useCompilationDatabase", "", false );
+		p->addMapping( _ui->compilationDatabaseEdit, "compilationDatabase", "", "" );
 	}
 } // end of depgraphV namespace
@@ -81,6 +81,7 @@ namespace depgraphV
 
 	private slots:
 		void _modifySelection();
+		void _browseCompilationDatabase();
 		void _updateSelectionCount();
 		virtual void onProjectOpened( Project* p );
 
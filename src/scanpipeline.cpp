@@ -0,0 +1,244 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * scanpipeline.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "scanpipeline.h"
+#include "helpers.h"
+
+namespace depgraphV
+{
+	/**
+	 * @brief Runs a stage of the pipeline on its thread pool.
+	 */
+	class ScanPipelineStage : public QRunnable
+	{
+	public:
+		ScanPipelineStage( const std::function<void()>& stage )
+			: _stage( stage )
+		{}
+
+		void run() { _stage(); }
+
+	private:
+		std::function<void()> _stage;
+	};
+	//-------------------------------------------------------------------------
+	ScanPipeline::ScanPipeline( const FolderWalker& walker, IncludeScanner::Mode mode,
+								IncludeResolver* resolver, QObject* parent )
+		: QObject( parent ),
+		  _walker( walker ),
+		  _mode( mode ),
+		  _resolver( resolver ),
+		  _parsedCount( 0 ),
+		  _cancellation( 0 ),
+		  _files( queueCapacity() ),
+		  _results( queueCapacity() ),
+		  _parsersCount( QThread::idealThreadCount() ),
+		  _runningParsers( 0 ),
+		  _resultsNotified( 0 ),
+		  _ioUringQueueDepth( 0 ),
+		  _batchedParsers( 0 ),
+		  _walkNsecs( 0 ),
+		  _totalNsecs( 0 )
+	{
+		//One more thread for the walker, which spawns its own workers
+		_pool.setMaxThreadCount( _parsersCount + 1 );
+	}
+	//-------------------------------------------------------------------------
+	ScanPipeline::~ScanPipeline()
+	{
+		_files.close();
+		_results.close();
+		_pool.waitForDone();
+	}
+	//-------------------------------------------------------------------------
+	void ScanPipeline::start( const QStringList& folders, QAtomicInt* parsedCount,
+							  const CancellationToken* cancellation )
+	{
+		_parsedCount = parsedCount;
+		_cancellation = cancellation;
+		_timer.start();
+		Helpers::atomicStore( _runningParsers, _parsersCount );
+
+		_pool.start( new ScanPipelineStage( std::bind( &ScanPipeline::_walk, this, folders ) ) );
+		for( int i = 0; i < _parsersCount; i++ )
+			_pool.start( new ScanPipelineStage( std::bind( &ScanPipeline::_parse, this ) ) );
+	}
+	//-------------------------------------------------------------------------
+	void ScanPipeline::cancel()
+	{
+		_files.close();
+		_results.close();
+	}
+	//-------------------------------------------------------------------------
+	bool ScanPipeline::takeResult( Graph::ParsedFile* file )
+	{
+		//Parsers notify again as soon as this is reset; anything they pushed
+		//before is drained by this call or by the following ones
+		Helpers::atomicStore( _resultsNotified, 0 );
+		return _results.tryPop( file );
+	}
+	//-------------------------------------------------------------------------
+	QStringList ScanPipeline::statistics() const
+	{
+		BoundedQueue<QString>::Statistics files = _files.statistics();
+		BoundedQueue<Graph::ParsedFile>::Statistics results = _results.statistics();
+		const qint64 nsecsPerMsec = 1000000;
+
+		return QStringList()
+				<< tr( "Walk took %1 ms, walk and parse %2 ms" )
+				   .arg( _walkNsecs / nsecsPerMsec ).arg( _totalNsecs / nsecsPerMsec )
+				<< tr( "Files queue: %1 files, peak depth %2 of %3; walker blocked "
+					   "%4 times (%5 ms), parsers starved %6 times (%7 ms)" )
+				   .arg( files.pushed ).arg( files.maxDepth ).arg( _files.capacity() )
+				   .arg( files.pushStalls ).arg( files.pushStallNsecs / nsecsPerMsec )
+				   .arg( files.popStalls ).arg( files.popStallNsecs / nsecsPerMsec )
+				<< tr( "Results queue: %1 files, peak depth %2 of %3; parsers "
+					   "blocked %4 times (%5 ms)" )
+				   .arg( results.pushed ).arg( results.maxDepth ).arg( _results.capacity() )
+				   .arg( results.pushStalls ).arg( results.pushStallNsecs / nsecsPerMsec )
+				<< ( _ioUringQueueDepth > 0
+					 ? tr( "Reads: io_uring with %1 files in flight on %2 of %3 parsers" )
+					   .arg( _ioUringQueueDepth ).arg( Helpers::atomicLoad( _batchedParsers ) )
+					   .arg( _parsersCount )
+					 : tr( "Reads: one file at a time on each of %1 parsers" )
+					   .arg( _parsersCount ) );
+	}
+	//-------------------------------------------------------------------------
+	void ScanPipeline::_walk( const QStringList& folders )
+	{
+		BoundedQueue<QString>* files = &_files;
+		_walker.walkParallel( folders, [ files ]( const QStringList& found )
+		{
+			foreach( QString path, found )
+				files->push( path );
+		} );
+
+		_walkNsecs = _timer.nsecsElapsed();
+		_files.close();
+	}
+	//-------------------------------------------------------------------------
+	void ScanPipeline::_parse()
+	{
+		QScopedPointer<BatchReader> reader;
+		if( _ioUringQueueDepth > 0 )
+			reader.reset( new BatchReader( _ioUringQueueDepth ) );
+
+		bool batched = false;
+		if( reader && reader->isValid() )
+		{
+			_batchedParsers.ref();
+			batched = _parseBatched( reader.data() );
+		}
+
+		//Also takes over the files left when the ring fails
+		if( !batched )
+		{
+			QString path;
+			while( _files.pop( &path ) && !CancellationToken::isCancelled( _cancellation ) )
+			{
+				if( !_deliver( Graph::parseFile( path, _mode, _resolver ) ) )
+					break;
+			}
+		}
+
+		//The last parser leaving closes the pipeline
+		if( !_runningParsers.deref() )
+		{
+			_totalNsecs = _timer.nsecsElapsed();
+			_results.close();
+			emit finished();
+		}
+	}
+	//-------------------------------------------------------------------------
+	bool ScanPipeline::_parseBatched( BatchReader* reader )
+	{
+		//Entries outdated by a new stamp, kept for the files being read
+		QHash<QString, ParseCache::Entry> outdated;
+		bool stopped = false;
+
+		BoundedQueue<QString>* files = &_files;
+		auto source = [ files, &stopped ]( QString* path, bool wait ) -> bool
+		{
+			if( stopped )
+				return false;
+
+			return wait ? files->pop( path ) : files->tryPop( path );
+		};
+
+		auto stampSink = [ this, &outdated, &stopped ]( const QString& path,
+														const ParseCache::FileStamp& stamp ) -> bool
+		{
+			Graph::ParsedFile file;
+			ParseCache::Entry entry;
+			if( !Graph::parseCachedFile( path, _mode, _resolver, stamp, &file, &entry ) )
+			{
+				if( entry )
+					outdated.insert( path, entry );
+
+				return true;
+			}
+
+			stopped = stopped || !_deliver( file );
+			return false;
+		};
+
+		auto contentSink = [ this, &outdated, &stopped ]( const QString& path,
+														  const ParseCache::FileStamp& stamp,
+														  const char* data, qint64 size )
+		{
+			ParseCache::Entry entry = outdated.take( path );
+			Graph::ParsedFile file = Graph::parseFileContent( path, _mode, _resolver,
+															  stamp, entry, data, size
+			);
+			stopped = stopped || !_deliver( file );
+		};
+
+		return reader->read( source, stampSink, contentSink, _cancellation ) || stopped;
+	}
+	//-------------------------------------------------------------------------
+	bool ScanPipeline::_deliver( const Graph::ParsedFile& file )
+	{
+		_parsedCount->ref();
+		if( !_results.push( file ) )
+			return false;
+
+		if( _resultsNotified.testAndSetOrdered( 0, 1 ) )
+			emit resultsReady();
+
+		return true;
+	}
+}
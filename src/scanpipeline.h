@@ -0,0 +1,159 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * scanpipeline.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef SCANPIPELINE_H
+#define SCANPIPELINE_H
+
+#ifndef GRAPH_H
+#	include "graph.h"
+#endif
+
+#ifndef FOLDERWALKER_H
+#	include "folderwalker.h"
+#endif
+
+#ifndef BOUNDEDQUEUE_H
+#	include "boundedqueue.h"
+#endif
+
+#ifndef BATCHREADER_H
+#	include "batchreader.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The ScanPipeline class walks folders and parses the files found
+	 * at the same time, so that disk latency hides behind parsing.
+	 *
+	 * The folder walker pushes file paths into a bounded queue consumed by a
+	 * pool of parsers, which push their results into a second bounded queue;
+	 * the owner drains it with takeResult() whenever resultsReady() is
+	 * emitted, on its own thread. finished() is emitted once every file has
+	 * been parsed.
+	 */
+	class ScanPipeline : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		ScanPipeline( const FolderWalker& walker, IncludeScanner::Mode mode,
+					  IncludeResolver* resolver, QObject* parent = 0 );
+
+		/**
+		 * @brief ScanPipeline destructor; waits for the running stages.
+		 */
+		~ScanPipeline();
+
+		/**
+		 * @brief Start walking \a folders; \a parsedCount is incremented
+		 * each time a file has been parsed.
+		 * @param cancellation If not null, parsers stop as soon as it is
+		 * cancelled; pass the same token to the walker.
+		 */
+		void start( const QStringList& folders, QAtomicInt* parsedCount,
+					const CancellationToken* cancellation = 0 );
+
+		/**
+		 * @brief Wake up every stage blocked on a queue, so that they notice
+		 * the cancellation; finished() is still emitted.
+		 */
+		void cancel();
+
+		/**
+		 * @brief Read files through an io_uring per parser, keeping up to
+		 * \a queueDepth files in flight each; 0 (the default) reads them one
+		 * at a time. Parsers fall back to the latter if io_uring is not
+		 * available. Call it before start().
+		 */
+		void setIoUringQueueDepth( int queueDepth ) { _ioUringQueueDepth = queueDepth; }
+
+		/**
+		 * @brief Take the next parsed file, if any, without waiting.
+		 */
+		bool takeResult( Graph::ParsedFile* file );
+
+		/**
+		 * @brief Return a description of how each stage went: queue depths
+		 * and how often, and how long, the stages waited for each other.
+		 */
+		QStringList statistics() const;
+
+		static int queueCapacity() { return 1024; }
+
+	signals:
+		void resultsReady();
+		void finished();
+
+	private:
+		void _walk( const QStringList& folders );
+		void _parse();
+
+		/**
+		 * @brief Parse files read through \a reader.
+		 * @return False if the reader failed before the files ran out.
+		 */
+		bool _parseBatched( BatchReader* reader );
+
+		/**
+		 * @brief Hand \a file over to the owner.
+		 * @return False if the pipeline has been cancelled.
+		 */
+		bool _deliver( const Graph::ParsedFile& file );
+
+		FolderWalker _walker;
+		IncludeScanner::Mode _mode;
+		IncludeResolver* _resolver;
+		QAtomicInt* _parsedCount;
+		const CancellationToken* _cancellation;
+
+		BoundedQueue<QString> _files;
+		BoundedQueue<Graph::ParsedFile> _results;
+		QThreadPool _pool;
+		int _parsersCount;
+		QAtomicInt _runningParsers;
+		QAtomicInt _resultsNotified;
+		int _ioUringQueueDepth;
+		QAtomicInt _batchedParsers;
+
+		QElapsedTimer _timer;
+		qint64 _walkNsecs;
+		qint64 _totalNsecs;
+	};
+}
+
+#endif // SCANPIPELINE_H
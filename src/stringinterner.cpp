@@ -0,0 +1,215 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * stringinterner.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "stringinterner.h"
+
+namespace depgraphV
+{
+	const StringInterner::Id StringInterner::NoString = 0xffffffffu;
+
+	static const int CHUNK_SIZE = 64 * 1024;
+	static const int INITIAL_SLOTS = 1024;
+
+	StringInterner::StringInterner()
+		: _next( 0 ),
+		  _left( 0 ),
+		  _arenaBytes( 0 )
+	{
+		clear();
+	}
+	//-------------------------------------------------------------------------
+	StringInterner::~StringInterner()
+	{
+		foreach( char* chunk, _chunks )
+			delete[] chunk;
+	}
+	//-------------------------------------------------------------------------
+	StringInterner::Id StringInterner::intern( const QString& s, bool* added )
+	{
+		const QByteArray utf8 = s.toUtf8();
+		return intern( utf8.constData(), utf8.size(), added );
+	}
+	//-------------------------------------------------------------------------
+	StringInterner::Id StringInterner::intern( const char* utf8, int size, bool* added )
+	{
+		const quint32 hash = _hash( utf8, size );
+		const int mask = _slots.count() - 1;
+		int i = int( hash ) & mask;
+		for( ; _slots.at( i ) != NoString; i = ( i + 1 ) & mask )
+		{
+			const Id id = _slots.at( i );
+			if( _hashes.at( id ) == hash && int( _sizes.at( id ) ) == size &&
+					memcmp( _strings.at( id ), utf8, size ) == 0 )
+			{
+				if( added )
+					*added = false;
+
+				return id;
+			}
+		}
+
+		char* copy = _allocate( size + 1 );
+		memcpy( copy, utf8, size );
+		copy[ size ] = '\0';
+
+		const Id id = _strings.count();
+		_strings.append( copy );
+		_sizes.append( size );
+		_hashes.append( hash );
+		_slots[ i ] = id;
+		if( _strings.count() * 2 > _slots.count() )
+			_rehash( _slots.count() * 2 );
+
+		if( added )
+			*added = true;
+
+		return id;
+	}
+	//-------------------------------------------------------------------------
+	StringInterner::Id StringInterner::find( const QString& s ) const
+	{
+		const QByteArray utf8 = s.toUtf8();
+		return find( utf8.constData(), utf8.size() );
+	}
+	//-------------------------------------------------------------------------
+	StringInterner::Id StringInterner::find( const char* utf8, int size ) const
+	{
+		const quint32 hash = _hash( utf8, size );
+		const int mask = _slots.count() - 1;
+		for( int i = int( hash ) & mask; _slots.at( i ) != NoString; i = ( i + 1 ) & mask )
+		{
+			const Id id = _slots.at( i );
+			if( _hashes.at( id ) == hash && int( _sizes.at( id ) ) == size &&
+					memcmp( _strings.at( id ), utf8, size ) == 0 )
+				return id;
+		}
+
+		return NoString;
+	}
+	//-------------------------------------------------------------------------
+	QString StringInterner::string( Id id ) const
+	{
+		return QString::fromUtf8( _strings.at( id ), _sizes.at( id ) );
+	}
+	//-------------------------------------------------------------------------
+	void StringInterner::reserve( int count )
+	{
+		_strings.reserve( count );
+		_sizes.reserve( count );
+		_hashes.reserve( count );
+
+		int slotCount = _slots.count();
+		while( count * 2 > slotCount )
+			slotCount *= 2;
+
+		if( slotCount != _slots.count() )
+			_rehash( slotCount );
+	}
+	//-------------------------------------------------------------------------
+	qint64 StringInterner::bytes() const
+	{
+		return _arenaBytes +
+				qint64( _strings.capacity() ) * sizeof( const char* ) +
+				qint64( _sizes.capacity() + _hashes.capacity() + _slots.capacity() ) *
+				sizeof( quint32 );
+	}
+	//-------------------------------------------------------------------------
+	void StringInterner::clear()
+	{
+		foreach( char* chunk, _chunks )
+			delete[] chunk;
+
+		_chunks.clear();
+		_next = 0;
+		_left = 0;
+		_arenaBytes = 0;
+		_strings.clear();
+		_sizes.clear();
+		_hashes.clear();
+		_slots.fill( NoString, INITIAL_SLOTS );
+	}
+	//-------------------------------------------------------------------------
+	quint32 StringInterner::_hash( const char* utf8, int size )
+	{
+		//FNV-1a
+		quint32 hash = 2166136261u;
+		for( int i = 0; i < size; ++i )
+			hash = ( hash ^ quint8( utf8[ i ] ) ) * 16777619u;
+
+		return hash;
+	}
+	//-------------------------------------------------------------------------
+	char* StringInterner::_allocate( int size )
+	{
+		//Long strings get a chunk of their own, so that the current one
+		//is not wasted
+		if( size > CHUNK_SIZE / 4 )
+		{
+			char* chunk = new char[ size ];
+			_chunks.append( chunk );
+			_arenaBytes += size;
+			return chunk;
+		}
+
+		if( size > _left )
+		{
+			_next = new char[ CHUNK_SIZE ];
+			_left = CHUNK_SIZE;
+			_chunks.append( _next );
+			_arenaBytes += CHUNK_SIZE;
+		}
+
+		char* result = _next;
+		_next += size;
+		_left -= size;
+		return result;
+	}
+	//-------------------------------------------------------------------------
+	void StringInterner::_rehash( int slotCount )
+	{
+		_slots.fill( NoString, slotCount );
+		const int mask = _slots.count() - 1;
+		for( Id id = 0; id < Id( _strings.count() ); ++id )
+		{
+			int i = int( _hashes.at( id ) ) & mask;
+			while( _slots.at( i ) != NoString )
+				i = ( i + 1 ) & mask;
+
+			_slots[ i ] = id;
+		}
+	}
+}
@@ -0,0 +1,135 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * stringinterner.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef STRINGINTERNER_H
+#define STRINGINTERNER_H
+
+#ifndef BUILDSETTINGS_H
+#	include "buildsettings.h"
+#endif
+
+#ifndef DEPGRAPHV_ENABLE_PCH_SUPPORT
+#	include "depgraphv_pch.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The StringInterner class stores each distinct string once and
+	 * identifies it by a dense 32-bit id, so that paths repeated over and
+	 * over by the scan are compared and stored as ids.
+	 *
+	 * Strings are kept in UTF-8, NUL terminated, in large chunks filled one
+	 * after the other and only freed by clear(): utf8() can be handed to
+	 * GraphViz as is, and string() only builds a QString where one is
+	 * needed. Lookups go through an open addressing table of ids.
+	 *
+	 * @remarks Not thread safe.
+	 */
+	class StringInterner
+	{
+	public:
+		typedef quint32 Id;
+
+		//Returned by find() for unknown strings
+		static const Id NoString;
+
+		StringInterner();
+		~StringInterner();
+
+		/**
+		 * @brief Return the id of \a s, storing it if it is new.
+		 * @param added If not null, set to true if \a s has been stored.
+		 */
+		Id intern( const QString& s, bool* added = 0 );
+		Id intern( const char* utf8, int size, bool* added = 0 );
+
+		/**
+		 * @brief Return the id of \a s, or NoString.
+		 */
+		Id find( const QString& s ) const;
+		Id find( const char* utf8, int size ) const;
+		bool contains( const QString& s ) const { return find( s ) != NoString; }
+
+		/**
+		 * @brief Return the NUL terminated UTF-8 bytes of \a id, valid until
+		 * clear().
+		 */
+		const char* utf8( Id id ) const { return _strings.at( id ); }
+		int size( Id id ) const { return _sizes.at( id ); }
+		QString string( Id id ) const;
+
+		int count() const { return _strings.count(); }
+
+		/**
+		 * @brief Make room for \a count strings in the index, so that it is
+		 * not rebuilt while they are added.
+		 */
+		void reserve( int count );
+
+		/**
+		 * @brief Return the number of bytes allocated for the strings and
+		 * their index.
+		 */
+		qint64 bytes() const;
+
+		/**
+		 * @brief Free every string; ids are reused from 0.
+		 */
+		void clear();
+
+	private:
+		static quint32 _hash( const char* utf8, int size );
+		char* _allocate( int size );
+		void _rehash( int slotCount );
+
+		QVector<char*> _chunks;
+		char* _next;
+		int _left;
+		qint64 _arenaBytes;
+
+		QVector<const char*> _strings;
+		QVector<quint32> _sizes;
+		QVector<quint32> _hashes;
+		//Power of two sized, at most half full; free slots hold NoString
+		QVector<Id> _slots;
+
+		Q_DISABLE_COPY( StringInterner )
+	};
+}
+
+#endif // STRINGINTERNER_H
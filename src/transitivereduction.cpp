@@ -0,0 +1,235 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * transitivereduction.cpp
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "transitivereduction.h"
+
+#include <algorithm>
+
+namespace depgraphV
+{
+	//Smaller groups of components are not worth dispatching to the pool
+	static const int PARALLEL_THRESHOLD = 256;
+
+	namespace
+	{
+		/**
+		 * @brief Compute the reachability bitset of a component, restricted
+		 * to the columns [ first, first + words * 64 ), and flag its
+		 * outgoing condensed edges implied by another successor.
+		 */
+		struct ReachabilityStep
+		{
+			typedef void result_type;
+
+			const QVector<quint32>* offsets;
+			const QVector<quint32>* successors;
+			quint64* bitsets;
+			int words;
+			quint32 first;
+			quint32 last;
+			bool* redundant;
+
+			void operator()( const quint32& component ) const
+			{
+				quint64* row = bitsets + qint64( component ) * words;
+				const quint32 begin = offsets->at( component );
+				const quint32 end = offsets->at( component + 1 );
+
+				//Whatever a successor reaches is reachable by a longer path
+				for( quint32 i = begin; i < end; ++i )
+				{
+					const quint64* other = bitsets + qint64( successors->at( i ) ) * words;
+					for( int w = 0; w < words; ++w )
+						row[ w ] |= other[ w ];
+				}
+
+				for( quint32 i = begin; i < end; ++i )
+				{
+					const quint32 s = successors->at( i );
+					if( s < first || s >= last )
+						continue;
+
+					const quint32 bit = s - first;
+					const quint64 mask = Q_UINT64_C( 1 ) << ( bit % 64 );
+					if( row[ bit / 64 ] & mask )
+						redundant[ i ] = true;
+				}
+
+				for( quint32 i = begin; i < end; ++i )
+				{
+					const quint32 s = successors->at( i );
+					if( s >= first && s < last )
+						row[ ( s - first ) / 64 ] |= Q_UINT64_C( 1 ) << ( ( s - first ) % 64 );
+				}
+			}
+		};
+	}
+
+	TransitiveReduction::TransitiveReduction()
+	{
+		clear();
+	}
+	//-------------------------------------------------------------------------
+	bool TransitiveReduction::run( const DependencyGraph& graph,
+								   const CycleFinder& cycles,
+								   const CancellationToken* cancellation )
+	{
+		Q_ASSERT( graph.isCompact() );
+		QElapsedTimer timer;
+		timer.start();
+		clear();
+
+		//Condensed DAG, in CSR form: the distinct successors of each
+		//component, which all have smaller ids
+		const int count = cycles.componentCount();
+		QVector<quint64> pairs;
+		for( VertexId v = 0; v < VertexId( graph.vertexCount() ); ++v )
+		{
+			const quint32 source = cycles.component( v );
+			for( EdgeId e = graph.outBegin( v ); e < graph.outEnd( v ); ++e )
+			{
+				const quint32 target = cycles.component( graph.target( e ) );
+				if( source != target )
+					pairs.append( ( quint64( source ) << 32 ) | target );
+			}
+		}
+
+		std::sort( pairs.begin(), pairs.end() );
+		pairs.erase( std::unique( pairs.begin(), pairs.end() ), pairs.end() );
+
+		QVector<quint32> offsets( count + 1, 0 );
+		QVector<quint32> successors( pairs.count() );
+		for( int i = 0; i < pairs.count(); ++i )
+		{
+			++offsets[ ( pairs.at( i ) >> 32 ) + 1 ];
+			successors[ i ] = quint32( pairs.at( i ) );
+			Q_ASSERT( successors.at( i ) < ( pairs.at( i ) >> 32 ) );
+		}
+
+		for( int c = 0; c < count; ++c )
+			offsets[ c + 1 ] += offsets.at( c );
+
+		//Group the components by height, lowest first
+		QVector<quint32> heights( count, 0 );
+		quint32 maxHeight = 0;
+		for( int c = 0; c < count; ++c )
+		{
+			for( quint32 i = offsets.at( c ); i < offsets.at( c + 1 ); ++i )
+				heights[ c ] = qMax( heights.at( c ), heights.at( successors.at( i ) ) + 1 );
+
+			maxHeight = qMax( maxHeight, heights.at( c ) );
+		}
+
+		QVector<quint32> groupOffsets( maxHeight + 2, 0 );
+		foreach( quint32 h, heights )
+			++groupOffsets[ h + 1 ];
+
+		for( quint32 h = 0; h <= maxHeight; ++h )
+			groupOffsets[ h + 1 ] += groupOffsets.at( h );
+
+		QVector<quint32> byHeight( count );
+		QVector<quint32> next( groupOffsets );
+		for( int c = 0; c < count; ++c )
+			byHeight[ next[ heights.at( c ) ]++ ] = c;
+
+		//Flags of the condensed edges; each one is written by the step of
+		//its source only
+		QVector<bool> redundant( successors.count(), false );
+		const int totalWords = ( count + 63 ) / 64;
+		const int words = int( qBound( Q_INT64_C( 1 ),
+									   bitsetBudget() / 8 / qMax( count, 1 ),
+									   qint64( qMax( totalWords, 1 ) ) ) );
+		QVector<quint64> bitsets;
+
+		for( int firstWord = 0; firstWord < totalWords; firstWord += words )
+		{
+			bitsets.fill( 0, count * words );
+			ReachabilityStep step = { &offsets, &successors, bitsets.data(), words,
+									  quint32( firstWord ) * 64,
+									  quint32( qMin( firstWord + words, totalWords ) ) * 64,
+									  redundant.data() };
+
+			for( quint32 h = 0; h <= maxHeight; ++h )
+			{
+				if( CancellationToken::isCancelled( cancellation ) )
+				{
+					clear();
+					return false;
+				}
+
+				QVector<quint32>::iterator begin = byHeight.begin() + groupOffsets.at( h );
+				QVector<quint32>::iterator end = byHeight.begin() + groupOffsets.at( h + 1 );
+				if( end - begin < PARALLEL_THRESHOLD )
+					std::for_each( begin, end, step );
+				else
+					QtConcurrent::blockingMap( begin, end, step );
+			}
+		}
+
+		//Map the condensed edges back to the edges of the graph
+		_redundant.fill( false, graph.edgeCount() );
+		for( VertexId v = 0; v < VertexId( graph.vertexCount() ); ++v )
+		{
+			const quint32 source = cycles.component( v );
+			const quint32* row = successors.constData() + offsets.at( source );
+			const quint32* rowEnd = successors.constData() + offsets.at( source + 1 );
+			for( EdgeId e = graph.outBegin( v ); e < graph.outEnd( v ); ++e )
+			{
+				const quint32 target = cycles.component( graph.target( e ) );
+				if( source == target )
+					continue;
+
+				const quint32* i = std::lower_bound( row, rowEnd, target );
+				if( redundant.at( i - successors.constData() ) )
+				{
+					_redundant[ e ] = true;
+					_redundantEdges.append( e );
+				}
+			}
+		}
+
+		_elapsed = timer.elapsed();
+		return true;
+	}
+	//-------------------------------------------------------------------------
+	void TransitiveReduction::clear()
+	{
+		_redundant.clear();
+		_redundantEdges.clear();
+		_elapsed = 0;
+	}
+}
@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ *                _                                        _
+ *             __| | ___ _ __         __ _ _ __ __ _ _ __ | |__/\   /\
+ *            / _` |/ _ \ '_ \ _____ / _` | '__/ _` | '_ \| '_ \ \ / /
+ *           | (_| |  __/ |_) |_____| (_| | | | (_| | |_) | | | \ V /
+ *            \__,_|\___| .__/       \__, |_|  \__,_| .__/|_| |_|\_/
+ *                      |_|          |___/          |_|
+ *
+ ******************************************************************************
+ *
+ * transitivereduction.h
+ *
+ * This source file is part of dep-graphV - An useful tool to analize header
+ * dependendencies via graphs.
+ *
+ * This software is distributed under the MIT License:
+ *
+ * Copyright (c) 2013 - 2015 Francesco Guastella aka romeoxbm
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef TRANSITIVEREDUCTION_H
+#define TRANSITIVEREDUCTION_H
+
+#ifndef CYCLEFINDER_H
+#	include "cyclefinder.h"
+#endif
+
+namespace depgraphV
+{
+	/**
+	 * @brief The TransitiveReduction class finds the redundant edges of a
+	 * DependencyGraph: the edges from a to b where b can also be reached
+	 * from a through a longer path.
+	 *
+	 * The strongly connected components found by a CycleFinder are
+	 * condensed into a DAG first; edges within a component are never
+	 * redundant. Reachability is computed for each component as a bitset
+	 * of the components it reaches, ORing the bitsets of its successors
+	 * 64 bits at a time. Tarjan numbers each component after all of the
+	 * ones it reaches, so components are grouped by height (the longest
+	 * path to a sink) and each group is processed in parallel once the
+	 * lower ones are done. When the bitsets of every component would not
+	 * fit in bitsetBudget() bytes, they are computed a range of columns
+	 * at a time.
+	 */
+	class TransitiveReduction
+	{
+	public:
+		typedef DependencyGraph::VertexId VertexId;
+		typedef DependencyGraph::EdgeId EdgeId;
+
+		TransitiveReduction();
+
+		/**
+		 * @brief Find the redundant edges of \a graph, which must be compact,
+		 * from its components in \a cycles.
+		 * @return False if \a cancellation has been cancelled meanwhile; the
+		 * results are cleared then.
+		 */
+		bool run( const DependencyGraph& graph, const CycleFinder& cycles,
+				  const CancellationToken* cancellation = 0 );
+
+		/**
+		 * @brief Return true if the edge \a e is implied by a longer path.
+		 */
+		bool isRedundant( EdgeId e ) const { return _redundant.at( e ); }
+
+		/**
+		 * @brief Return the redundant edges, by increasing id.
+		 */
+		const QVector<EdgeId>& redundantEdges() const { return _redundantEdges; }
+
+		/**
+		 * @brief Return how many milliseconds the last run() took.
+		 */
+		qint64 elapsed() const { return _elapsed; }
+
+		/**
+		 * @brief Return the maximum number of bytes used by the bitsets.
+		 */
+		static qint64 bitsetBudget() { return Q_INT64_C( 256 ) * 1024 * 1024; }
+
+		void clear();
+
+	private:
+		QVector<bool> _redundant;
+		QVector<EdgeId> _redundantEdges;
+		qint64 _elapsed;
+	};
+}
+
+#endif // TRANSITIVEREDUCTION_H